@@ -0,0 +1,157 @@
+function [sts, info, data] = import_acq(filename)
+% ● Description
+%   import_acq reads Biopac AcqKnowledge files (version 3.9.0 or lower). The
+%   file is read into memory with a single fread call, the header structs
+%   are decoded at the offsets given in Biopac's application note #156, and
+%   the interleaved sample stream (with channel-specific sample dividers)
+%   is de-interleaved in one pass. This function should be called by
+%   pspm_get_acq.
+% ● Format
+%   [sts, info, data] = import_acq(filename)
+% ● Arguments
+%   *  filename : path to the .acq file.
+% ● Outputs
+%   *       sts : 1 if the file was read successfully, -1 otherwise.
+%   *      info : header information, using the field names of acqread
+%                 (lVersion, nChannels, dSampleTime, szCommentText,
+%                 szUnitsText, lBufLength, dAmplScale, dAmplOffset,
+%                 nVarSampleDivider, nSize, nType, lSample, szText).
+%   *      data : cell array, indexed by channel, containing the raw
+%                 (unscaled) samples of each channel as column vectors in
+%                 their native type (int16 or double).
+% ● Developer's notes
+%   Header and channel header lengths are taken from the file
+%   (lExtItemHeaderLen and lChanHeaderLen), so that fields not used by
+%   PsPM are skipped rather than parsed. Compressed files are not
+%   supported, as with acqread.
+% ● References
+%   [1] Biopac Systems. Application Note #156: AcqKnowledge file format
+%       for PC with Windows. 2007. See Import/acq/app156.pdf.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+sts = -1;
+info = struct();
+data = {};
+if ~exist(filename, 'file')
+  warning('ID:invalid_input', 'File ''%s'' not found.', filename); return;
+end
+fid = fopen(filename, 'r', 'ieee-le');
+if fid < 0
+  warning('ID:invalid_input', 'File ''%s'' could not be opened.', filename); return;
+end
+bytes = fread(fid, Inf, '*uint8');
+fclose(fid);
+
+%% Graph header
+if numel(bytes) >= 24
+  info.lVersion = double(getval(bytes, 2, 'int32'));
+end
+if numel(bytes) < 24 || info.lVersion < 30 || info.lVersion > 45
+  warning('ID:invalid_data_structure', ...
+    'Unable to read file ''%s'': invalid file type, or unsupported file version.', filename);
+  return
+end
+lExtItemHeaderLen = double(getval(bytes, 6, 'int32'));
+info.nChannels = double(getval(bytes, 10, 'int16'));
+info.dSampleTime = getval(bytes, 16, 'double');
+nch = info.nChannels;
+
+%% Per channel data section
+info.szCommentText = cell(1, nch);
+info.szUnitsText = cell(1, nch);
+info.lBufLength = zeros(1, nch);
+info.dAmplScale = zeros(1, nch);
+info.dAmplOffset = zeros(1, nch);
+info.nVarSampleDivider = ones(1, nch);
+pos = lExtItemHeaderLen;
+for n = 1:nch
+  info.szCommentText{n} = getstr(bytes, pos + 6, 40);
+  info.szUnitsText{n} = getstr(bytes, pos + 68, 20);
+  info.lBufLength(n) = double(getval(bytes, pos + 88, 'int32'));
+  info.dAmplScale(n) = getval(bytes, pos + 92, 'double');
+  info.dAmplOffset(n) = getval(bytes, pos + 100, 'double');
+  if info.lVersion >= 38
+    info.nVarSampleDivider(n) = double(getval(bytes, pos + 250, 'int16'));
+  end
+  pos = pos + double(getval(bytes, pos, 'int32'));
+end
+
+%% Foreign data section
+pos = pos + double(getval(bytes, pos, 'int16'));
+
+%% Per channel data types section
+types = double(typecast(bytes(pos + (1:4 * nch)), 'int16'));
+info.nSize = types(1:2:end)';
+info.nType = types(2:2:end)';
+pos = pos + 4 * nch;
+
+%% Channel data section
+% one period of the interleaved stream contains each channel once every
+% nVarSampleDivider base samples
+div = info.nVarSampleDivider;
+period = max(div);
+slot = false(period, nch);
+for n = 1:nch
+  slot(1:div(n):period, n) = true;
+end
+% byte offset of every channel occurrence within one period, in file order
+slotsize = bsxfun(@times, slot', info.nSize(:));
+slotoffset = reshape(cumsum([0; slotsize(1:end - 1)']), nch, period);
+periodbytes = sum(slotsize(:));
+data = cell(1, nch);
+for n = 1:nch
+  offsets = slotoffset(n, slot(:, n))';
+  j = (0:info.lBufLength(n) - 1)';
+  start = pos + floor(j / numel(offsets)) * periodbytes + offsets(mod(j, numel(offsets)) + 1);
+  idx = bsxfun(@plus, (1:info.nSize(n))', start');
+  if any(idx(:) > numel(bytes))
+    warning('ID:invalid_data_structure', 'Data section of file ''%s'' is truncated.', filename);
+    return
+  end
+  if info.nType(n) == 1
+    data{n} = typecast(bytes(idx(:)), 'double');
+  else
+    data{n} = typecast(bytes(idx(:)), 'int16');
+  end
+end
+pos = pos + sum(info.lBufLength .* info.nSize);
+
+%% Markers
+info.lSample = [];
+info.szText = {};
+if pos + 8 <= numel(bytes)
+  lLength = double(getval(bytes, pos, 'int32'));
+  lMarkers = double(getval(bytes, pos + 4, 'int32'));
+  pos = pos + 8;
+  if lLength > 0 && lMarkers > 0
+    info.lSample = zeros(1, lMarkers);
+    info.szText = cell(1, lMarkers);
+    for n = 1:lMarkers
+      info.lSample(n) = double(getval(bytes, pos, 'int32'));
+      nTextLength = double(getval(bytes, pos + 10, 'int16'));
+      info.szText{n} = getstr(bytes, pos + 12, nTextLength + 1);
+      pos = pos + 12 + nTextLength + 1;
+    end
+  end
+end
+sts = 1;
+return
+
+function val = getval(bytes, offset, type)
+% getval returns one value of the given type at a zero-based byte offset
+switch type
+  case 'int16'
+    n = 2;
+  case 'int32'
+    n = 4;
+  case 'double'
+    n = 8;
+end
+val = typecast(bytes(offset + (1:n)), type);
+
+function str = getstr(bytes, offset, n)
+% getstr returns a zero-terminated string of at most n characters
+str = char(bytes(offset + (1:n))');
+str = deblank(str(1:find([str, char(0)] == 0, 1) - 1));
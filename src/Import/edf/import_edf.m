@@ -0,0 +1,173 @@
+function [sts, out] = import_edf(fn, trigchan)
+% ● Description
+%   import_edf reads European Data Format (EDF and EDF+) files in a single
+%   sweep. The header is parsed with one block read per header section, all
+%   data records are read with one fread call, and signal channels, EDF+
+%   time-stamped annotation lists (TAL) and trigger flanks are all extracted
+%   from this one copy of the data records. This function should be called
+%   by pspm_get_edf.
+% ● Format
+%   [sts, out] = import_edf(fn)
+%   [sts, out] = import_edf(fn, trigchan)
+% ● Arguments
+%   *          fn : path to the EDF/EDF+ file.
+%   *    trigchan : [optional] vector of signal channel numbers from which
+%                   trigger flanks are to be extracted. Default: none.
+% ● Outputs
+%   *         sts : 1 if the file was read successfully, -1 otherwise.
+%   ┌─────────out
+%   ├────────.hdr : header information. Contains the fields label, units,
+%   │               sr (per channel), nsamples (per record), nrec, recdur,
+%   │               startdate, starttime, edfplus and annotation (logical
+%   │               index of EDF Annotations channels).
+%   ├───────.data : cell array with one column vector of physical values per
+%   │               channel; empty for EDF Annotations channels.
+%   ├.annotations : struct with the fields onset (seconds from recording
+%   │               start), duration (seconds, NaN if not given) and label
+%   │               (cell array of char), one element per annotation.
+%   └───.triggers : cell array with one struct per channel in trigchan, with
+%                   the fields onset, duration (both in seconds) and value
+%                   (signal value after the ascending flank).
+% ● Developer's notes
+%   The time-keeping TAL at the start of each data record carries an empty
+%   annotation and is therefore not returned. Trigger flanks are detected
+%   on the digital values, i.e. before calibration, and a flank is any
+%   change to a value larger than the previous one.
+% ● References
+%   [1] Kemp B, Olivan J. European data format 'plus' (EDF+), an EDF alike
+%       standard format for the exchange of physiological data. Clinical
+%       Neurophysiology 2003, 114:1755-1761. https://www.edfplus.info
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+sts = -1;
+out = struct();
+if nargin < 2
+  trigchan = [];
+end
+if ~exist(fn, 'file')
+  warning('ID:invalid_input', 'File ''%s'' not found.', fn); return;
+end
+fid = fopen(fn, 'r', 'ieee-le');
+if fid < 0
+  warning('ID:invalid_input', 'File ''%s'' could not be opened.', fn); return;
+end
+
+%% Read fixed header (256 bytes)
+fixhdr = fread(fid, [1, 256], '*char');
+if numel(fixhdr) < 256 || ~strcmp(fixhdr(1:8), '0       ')
+  fclose(fid);
+  warning('ID:invalid_data_structure', '''%s'' is not an EDF/EDF+ file.', fn); return;
+end
+hdr = struct();
+hdr.startdate = strtrim(fixhdr(169:176));
+hdr.starttime = strtrim(fixhdr(177:184));
+hdr.edfplus   = strncmp(fixhdr(193:236), 'EDF+', 4);
+hdr.nrec      = str2double(fixhdr(237:244));
+hdr.recdur    = str2double(fixhdr(245:252));
+ns            = str2double(fixhdr(253:256));
+
+%% Read signal headers (ns x 256 bytes) in one block
+sighdr = fread(fid, [1, ns * 256], '*char');
+if numel(sighdr) < ns * 256
+  fclose(fid);
+  warning('ID:invalid_data_structure', 'Header of ''%s'' is truncated.', fn); return;
+end
+fieldlen = [16 80 8 8 8 8 8 80 8 32];
+fieldpos = [0 cumsum(fieldlen * ns)];
+getfield_str = @(i) cellstr(reshape(sighdr(fieldpos(i) + 1:fieldpos(i + 1)), fieldlen(i), ns)');
+getfield_num = @(i) str2double(getfield_str(i));
+hdr.label    = strtrim(getfield_str(1));
+hdr.units    = strtrim(getfield_str(3));
+physmin      = getfield_num(4);
+physmax      = getfield_num(5);
+digmin       = getfield_num(6);
+digmax       = getfield_num(7);
+hdr.nsamples = getfield_num(9);
+hdr.annotation = strcmp(hdr.label, 'EDF Annotations');
+if hdr.recdur > 0
+  hdr.sr = hdr.nsamples / hdr.recdur;
+else
+  % EDF+ files without signals may have a record duration of 0
+  hdr.sr = zeros(ns, 1);
+end
+
+%% Read all data records in one call
+recsamp = sum(hdr.nsamples);
+raw = fread(fid, [recsamp, Inf], 'int16=>int16');
+fclose(fid);
+if hdr.nrec < 0 || size(raw, 2) < hdr.nrec
+  % number of records unknown (-1) or file truncated
+  hdr.nrec = size(raw, 2);
+end
+raw = raw(:, 1:hdr.nrec);
+
+%% Extract signals and annotations from the records
+offset = [0; cumsum(hdr.nsamples)];
+gain = (physmax - physmin) ./ (digmax - digmin);
+data = cell(ns, 1);
+annot_bytes = cell(ns, 1);
+for ch = 1:ns
+  rows = offset(ch) + 1:offset(ch + 1);
+  if hdr.annotation(ch)
+    annot_bytes{ch} = typecast(reshape(raw(rows, :), [], 1), 'uint8');
+  else
+    data{ch} = (double(reshape(raw(rows, :), [], 1)) - digmin(ch)) * gain(ch) + physmin(ch);
+  end
+end
+annotations = parse_tal(vertcat(annot_bytes{:}));
+
+%% Trigger flanks
+triggers = cell(numel(trigchan), 1);
+for k = 1:numel(trigchan)
+  ch = trigchan(k);
+  if ch < 1 || ch > ns || hdr.annotation(ch)
+    warning('ID:channel_not_contained_in_file', ...
+      'Channel %02.0f is not a signal channel in file %s.', ch, fn); return;
+  end
+  dig = double(reshape(raw(offset(ch) + 1:offset(ch + 1), :), [], 1));
+  % indices of all value changes, the end of the recording closes the last
+  % event
+  chg = [find(diff(dig) ~= 0) + 1; numel(dig) + 1];
+  up = find(dig(chg(1:end - 1)) > dig(chg(1:end - 1) - 1));
+  triggers{k}.onset    = (chg(up) - 1) / hdr.sr(ch);
+  triggers{k}.duration = (chg(up + 1) - chg(up)) / hdr.sr(ch);
+  triggers{k}.value    = (dig(chg(up)) - digmin(ch)) * gain(ch) + physmin(ch);
+end
+
+%% Sort outputs
+out.hdr = hdr;
+out.data = data;
+out.annotations = annotations;
+out.triggers = triggers;
+sts = 1;
+return
+
+function annotations = parse_tal(bytes)
+% parse_tal splits the byte stream of all annotation channels into
+% time-stamped annotation lists and returns one entry per annotation.
+annotations = struct('onset', zeros(0, 1), 'duration', zeros(0, 1), 'label', {cell(0, 1)});
+if isempty(bytes)
+  return
+end
+txt = char(bytes(:)');
+% each TAL is +onset[\x15duration]\x14annotation\x14...\x14 and TALs are
+% terminated by \x00
+tal = regexp(txt, '([+-][0-9.]+)(?:\x15([0-9.]*))?\x14([^\x00]*)', 'tokens');
+onset = cell(numel(tal), 1);
+duration = cell(numel(tal), 1);
+label = cell(numel(tal), 1);
+for k = 1:numel(tal)
+  labels = regexp(tal{k}{3}, '[^\x14]+', 'match');
+  n = numel(labels);
+  onset{k} = repmat(str2double(tal{k}{1}), n, 1);
+  duration{k} = repmat(str2double(tal{k}{2}), n, 1);
+  label{k} = labels(:);
+end
+onset = vertcat(onset{:}, zeros(0, 1));
+[annotations.onset, idx] = sort(onset);
+duration = vertcat(duration{:}, zeros(0, 1));
+annotations.duration = duration(idx);
+label = vertcat(label{:}, cell(0, 1));
+annotations.label = label(idx);
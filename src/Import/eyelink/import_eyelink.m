@@ -30,6 +30,12 @@ function [data] = import_eyelink(filepath)
 %                       elcl_proc: Pupil tracking algorithm. (ellipse or centroid)
 %                       record_date: Recording date
 %                       record_time: Recording time
+%
+%           Message lines are extracted and commented out in vectorised
+%           passes, sample lines of each session are read with a single
+%           textscan call, and blink/saccade and marker lines are tokenised
+%           with one regexp call each, so that import time grows linearly
+%           with file size.
 %__________________________________________________________________________
 %
 % (C) 2019 Eshref Yozdemir
@@ -40,14 +46,11 @@ end
 
 % parse datafile
 % --------------
-bsearch_path = pspm_path('ext', 'bsearch');
-addpath(bsearch_path);
 [dataraw, messages, chan_info, file_info] = parse_eyelink_file(filepath);
 markers_sess = {};
 for i = 1:numel(messages)
   [dataraw{i}, markers_sess{i}, chan_info{i}] = parse_messages(messages{i}, dataraw{i}, chan_info{i});
 end
-rmpath(bsearch_path);
 
 % write outputs
 % -------------
@@ -137,12 +140,9 @@ chan_info = parse_session_headers(messages);
 % TODO: assert that session configs are the same
 chan_info = pspm_chans_in_file(chan_info);
 
-for i = 1:numel(msg_linenums)
-  for msg_line = msg_linenums{i}
-    begidx = linefeeds(msg_line) + 1;
-    str(begidx : begidx + 1) = '/';
-  end
-end
+% comment out all message lines at once so that textscan skips them
+begidx = linefeeds([msg_linenums{:}]) + 1;
+str([begidx, begidx + 1]) = '/';
 
 session_data_beg_end_indices = [];
 for i = 1:numel(chan_info)
@@ -233,11 +233,11 @@ ord_A = int32('A');
 ord_Z = int32('Z');
 msg_linenums = find(linebegs >= ord_A & linebegs <= ord_Z);
 
-messages = {};
-for msg_line = msg_linenums
-  begidx = linefeeds(msg_line) + 1;
-  endidx = linefeeds(msg_line + 1) - 1 - has_backr;
-  messages{end + 1} = str(begidx : endidx);
+messages = cell(1, numel(msg_linenums));
+for k = 1:numel(msg_linenums)
+  begidx = linefeeds(msg_linenums(k)) + 1;
+  endidx = linefeeds(msg_linenums(k) + 1) - 1 - has_backr;
+  messages{k} = str(begidx : endidx);
 end
 end
 
@@ -278,38 +278,36 @@ session_end_time = timecol(end);
 [messages, esacc_indices] = balance_starts_and_ends(ssacc_indices, esacc_indices, messages, 'ESACC', session_end_time);
 
 % set blink and saccade events
-for idx = [eblink_indices esacc_indices]
-  msgline = messages{idx};
-  parts = split(msgline);
-
-  msgtype = parts{1};
-  which_eye = lower(parts{2});
-  start_time = str2num(parts{3});
-  end_time = str2num(parts{4});
-
-  index_of_beg = bsearch(timecol, start_time);
-  index_of_end = bsearch(timecol, end_time);
-  if strcmp(msgtype, 'ESACC') && which_eye == 'l'
-    saccades_L(index_of_beg : index_of_end) = true;
-  elseif strcmp(msgtype, 'ESACC') && which_eye == 'r'
-    saccades_R(index_of_beg : index_of_end) = true;
-  elseif strcmp(msgtype, 'EBLINK') && which_eye == 'l'
-    blinks_L(index_of_beg : index_of_end) = true;
-  elseif strcmp(msgtype, 'EBLINK') && which_eye == 'r'
-    blinks_R(index_of_beg : index_of_end) = true;
+% all event lines are tokenised at once and their start and end times are
+% looked up in one call, then each event type is turned into a mask with
+% pspm_intervals
+event_indices = [eblink_indices esacc_indices];
+if ~isempty(event_indices)
+  parts = tokenise_lines(messages(event_indices), '^(\S+)\s+(\S+)\s+(\S+)\s+(\S+)', 4);
+  msgtype = parts(:, 1);
+  which_eye = lower(parts(:, 2));
+  n_events = numel(event_indices);
+  index_of_event = pspm_bsearch(timecol, str2double([parts(:, 3); parts(:, 4)]));
+  index_of_beg = index_of_event(1 : n_events);
+  index_of_end = index_of_event(n_events + 1 : end);
+  is_sacc = strcmp(msgtype, 'ESACC');
+  is_blink = strcmp(msgtype, 'EBLINK');
+  if contains(eyes, 'l')
+    sel = strcmp(which_eye, 'l');
+    saccades_L = pspm_intervals('to_logical', [index_of_beg(is_sacc & sel), index_of_end(is_sacc & sel) + 1], numel(timecol));
+    blinks_L = pspm_intervals('to_logical', [index_of_beg(is_blink & sel), index_of_end(is_blink & sel) + 1], numel(timecol));
+  end
+  if contains(eyes, 'r')
+    sel = strcmp(which_eye, 'r');
+    saccades_R = pspm_intervals('to_logical', [index_of_beg(is_sacc & sel), index_of_end(is_sacc & sel) + 1], numel(timecol));
+    blinks_R = pspm_intervals('to_logical', [index_of_beg(is_blink & sel), index_of_end(is_blink & sel) + 1], numel(timecol));
   end
 end
 
 % construct markers
-markers.times = [];
-markers.names = {};
-for idx = msg_indices
-  msgline = messages{idx};
-  parts = split(msgline);
-  time = str2num(parts{2});
-  markers.times(end + 1, 1) = time;
-  markers.names{end + 1, 1} = cell2mat(join(parts(3:end), ' '));
-end
+parts = tokenise_lines(messages(msg_indices), '^\S+\s+(\S+)\s*(.*)$', 2);
+markers.times = str2double(parts(:, 1));
+markers.names = regexprep(parts(:, 2), '\s+', ' ');
 
 % set data columns
 if contains(eyes, 'l')
@@ -434,12 +432,21 @@ if numel(beg_indices) > numel(end_indices)
     beg_time = str2num(parts{3});
     end_time = session_end_time;
 
-    messages{end + 1} = sprintf('%s %c %d (ADDED BY PSPM)', event_name, which_eye, end_time);
+    messages{end + 1} = sprintf('%s %c %d %d (ADDED BY PSPM)', event_name, which_eye, beg_time, end_time);
     end_indices(end + 1) = numel(messages);
   end
 end
 end
 
+function parts = tokenise_lines(lines, expr, n_tokens)
+% Tokenise a cell array of message lines with one regular expression call
+% and return an n_lines x n_tokens cell array. Lines that do not match
+% return empty tokens.
+parts = regexp(lines(:), expr, 'tokens', 'once');
+parts(cellfun(@isempty, parts)) = {repmat({''}, 1, n_tokens)};
+parts = vertcat(parts{:}, cell(0, n_tokens));
+end
+
 function markers_sess = create_marker_val_fields(markers_sess)
 all_marker_names = {};
 for i = 1:numel(markers_sess)
@@ -27,6 +27,13 @@ function [info, data] = nReadDataq(filename)
 %
 % Things the function does not do:
 % - it does not read the file trailer
+%
+% Samples of unpacked files are read in a single memory-mapped pass and
+% de-interleaved, stripped of the two status bits and calibrated on the
+% whole channels x samples matrix. Sample indices of event markers (bit 0
+% of the first channel) are returned in info.eventMarkers, which is empty
+% for hiRes files. hiRes samples are divided by 4 in double precision,
+% without rounding to integers.
 % 
 % Author: Tobias Moser (University of Zurich) in Feb. 2015
 
@@ -282,26 +289,63 @@ info.numberOfSamplesWritten = info.adcDataBytes / 2 / uint32(info.totalChannelsA
 %% DATA section
 
 % after the fileheader is where to find the acquired data
-data = cell(1,info.totalChannelsAcquired);
-for i=1:info.totalChannelsAcquired,
-    fseek(fid, info.bytesInDataFileHeader + int16(2*(i-1)), -1);
-    % read data
-    if info.packedFile
-        % does this make sense, because reading
-        nSamples = info.numberOfChannelSamples(i);
-    else
-        nSamples = info.numberOfSamplesWritten;
-    end
-    data{i} = fread(fid, nSamples, '*int16', 2*(info.totalChannelsAcquired -1));
-    % convert data to an equivalent engineering unit
-    % - shift 16bit number to the right by two bits
-    % - multiply by slope m
-    % - add the intercept b
+nch = double(info.totalChannelsAcquired);
+data = cell(1,nch);
+if info.packedFile
+    % packed files have channel-specific sample rate divisors and are
+    % therefore read channel by channel
+    raw = cell(1,nch);
+    for i=1:nch
+        fseek(fid, double(info.bytesInDataFileHeader) + 2*(i-1), -1);
+        raw{i} = fread(fid, double(info.numberOfChannelSamples(i)), '*int16', 2*(nch-1))';
+    end;
+else
+    % unpacked files are read in one go as a channels x samples matrix,
+    % memory-mapped if possible, and de-interleaved by the reshape
+    nSamples = double(info.numberOfSamplesWritten);
+    try
+        mm = memmapfile(filename, 'Offset', double(info.bytesInDataFileHeader), ...
+            'Format', {'int16', [nch, nSamples], 'x'}, 'Repeat', 1);
+        raw = mm.Data.x;
+        clear mm;
+    catch
+        fseek(fid, double(info.bytesInDataFileHeader), -1);
+        raw = fread(fid, [nch, nSamples], '*int16');
+    end;
+end;
+
+% event markers are flagged in the least significant bit of the first
+% channel; in hiRes files, this bit is part of the sample
+if info.hiResFile
+    info.eventMarkers = [];
+elseif iscell(raw)
+    info.eventMarkers = find(mod(raw{1}, 2))';
+else
+    info.eventMarkers = find(mod(raw(1, :), 2))';
+end;
+
+% convert data to an equivalent engineering unit
+% - shift 16bit number to the right by two bits (remove status bits)
+% - multiply by slope m
+% - add the intercept b
+m = double(info.calibrationScalingFactor(:));
+b = double(info.calibrationInterceptFactor(:));
+if iscell(raw)
+    for i=1:nch
+        if info.hiResFile
+            data{i} = double(raw{i}')*0.25*m(i)+b(i);
+        else
+            data{i} = double(bitshift(raw{i}', -2))*m(i)+b(i);
+        end;
+    end;
+else
     if info.hiResFile
-        data{i} = double(data{i}*0.25)*info.calibrationScalingFactor(i)+info.calibrationInterceptFactor(i);
+        raw = double(raw)*0.25;
     else
-        data{i} = double(bitshift(data{i}, -2))*info.calibrationScalingFactor(i)+info.calibrationInterceptFactor(i);
+        raw = double(bitshift(raw, -2));
     end;
+    raw = bsxfun(@plus, bsxfun(@times, raw, m), b);
+    data = num2cell(raw', 1);
 end;
 
 fclose(fid);
@@ -99,9 +99,6 @@ function [data] = import_smi(varargin)
         curr_line = all_text(line_begs(line_ctr) : line_begs(line_ctr + 1) - back_off);
     end
     header_sample = transpose(header_sample);
-    line_begs = line_begs(line_ctr + 1 : end);
-    all_text = all_text(line_begs(1) : end);
-    line_begs = line_begs - line_begs(1) + 1;
     %% check columns of data
     % last line of the header descibes the columns contained in the importfile
     % (can be variable depending recodrings)
@@ -174,25 +171,16 @@ function [data] = import_smi(varargin)
     head_distance_unit = hd_field{4}(2:3);
 
     %% get data part of sample file
-    msg_field_indices = strfind(all_text, sprintf('\tMSG\t'));
-    comment_indices = [];
-    msg_lines = {};
-    for i = 1:numel(msg_field_indices)
-        b = msg_field_indices(i);
-        while all_text(b) ~= backn
-            b = b - 1;
-        end
-        e = msg_field_indices(i);
-        while all_text(e) ~= backn
-            e = e + 1;
-        end
-        comment_indices(end + 1 : end + 2) = [b + 1, b + 2];
-        msg_lines{end + 1} = all_text(b + 1 : e - back_off + 1);
-    end
-    all_text(comment_indices) = '/';
-
+    % message lines are returned as text, all other lines after the column
+    % header are parsed as samples in a single textscan call
     formatSpec = ['%f%*s', repmat('%f', 1, numel(columns) - 2)];
-    C = textscan(all_text, formatSpec, 'Delimiter', '\t', 'CollectOutput', 1, 'TreatAsEmpty', '.', 'CommentStyle', '//');
+    routes = struct('pattern', {'[^\t\r\n]*\tMSG\t', ''}, ...
+        'format', {'', formatSpec}, ...
+        'options', {{}, {'Delimiter', '\t', 'CollectOutput', 1, 'TreatAsEmpty', '.'}});
+    [~, lines] = pspm_route_lines(all_text, routes, line_ctr + 1);
+    msg_lines = lines.route(1).data;
+    C = lines.route(2).data;
+    clear lines;
     datanum = C{1};
     clear C;
     clear all_text;
@@ -224,13 +212,14 @@ function [data] = import_smi(varargin)
             msgs{3, i} = eventsRaw.marker.msg{i};
         end
     else
-        nr_events = numel(msg_lines);
-        msgs = cell(3, nr_events);
-        for i=1:nr_events
-            C = textscan(msg_lines{i}, '%f%*s%f%s', 'Delimiter', '\t');
-            msgs{1, i} = C{1};
-            msgs{2, i} = C{2};
-            msgs{3, i} = C{3}{1};
+        % message lines are Time, MSG, Trial, Text
+        msgs = cell(3, 0);
+        tokens = regexp(msg_lines, '^([^\t]*)\t[^\t]*\t([^\t]*)\t([^\t]*)', 'tokens', 'once');
+        tokens = vertcat(tokens{:});
+        if ~isempty(tokens)
+            msgs = [num2cell(str2double(tokens(:, 1)))'; ...
+                num2cell(str2double(tokens(:, 2)))'; ...
+                strtrim(tokens(:, 3))'];
         end
     end
 
@@ -247,8 +236,6 @@ function [data] = import_smi(varargin)
     data = cell(n_sessions, 1);
     %% convert data, compute blink, saccade and messages
 
-    bsearch_path = pspm_path('ext', 'bsearch');
-    addpath(bsearch_path);
     for sn = 1:n_sessions
         data{sn} = struct();
         sn_datanum = datanum(sess_beg_end(sn) + 1:sess_beg_end(sn + 1), :);
@@ -361,10 +348,7 @@ function [data] = import_smi(varargin)
             data{sn}.markerinfos.name = msg_str;
 
             messages = unique(msg_str);
-            msg_indices_in_uniq = [];
-            for i = 1:numel(msg_str)
-                msg_indices_in_uniq(end + 1) = find(strcmpi(msg_str{i}, messages));
-            end
+            [~, msg_indices_in_uniq] = ismember(msg_str, messages);
             data{sn}.markerinfos.value = msg_indices_in_uniq;
         end
 
@@ -458,13 +442,12 @@ function [data] = import_smi(varargin)
             end
         end
     end
-    rmpath(bsearch_path);
 end
 
 function [s_idx,end_idx]=get_idx(time_vec,s_vec,end_vec)
     % function to find the idx of start and end
-    s_idx = bsearch(time_vec, s_vec);
-    end_idx = bsearch(time_vec, end_vec) + 1;
+    s_idx = pspm_bsearch(time_vec, s_vec);
+    end_idx = pspm_bsearch(time_vec, end_vec) + 1;
     if isempty(s_idx)
         error('ID:invalid_input', ['All values in the vector have ',...
             'starting times outside of the recording time. '],...
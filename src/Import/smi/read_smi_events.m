@@ -38,8 +38,6 @@ function out = read_smi_events(filepath)
     %__________________________________________________________________________
     %
     % (C) 2019 Eshref Yozdemir
-    bsearch_path = pspm_path('ext', 'bsearch');
-    addpath(bsearch_path);
 
     if ~exist(filepath,'file')
         error('ID:invalid_input', sprintf('Passed file %s does not exist.', filepath));
@@ -51,13 +49,7 @@ function out = read_smi_events(filepath)
 
     [header_struct, line_ctr] = parse_header(str, line_ctr, linefeeds, has_backr);
 
-    linefeeds = linefeeds(line_ctr : end);
-    str = str(linefeeds(1) + 1 : end);
-    linefeeds = linefeeds - linefeeds(1);
-    line_ctr = 1;
-
-    [markernum, msg, blink_l, blink_r, sacc_l, sacc_r] = parse_events(str, linefeeds, has_backr, header_struct);
-    rmpath(bsearch_path);
+    [markernum, msg, blink_l, blink_r, sacc_l, sacc_r] = parse_events(str, line_ctr, header_struct);
 
     out.blink_l.trial = blink_l(:, find(strcmpi(header_struct.blink_names, 'Trial')));
     out.blink_l.start = blink_l(:, find(strcmpi(header_struct.blink_names, 'Start')));
@@ -151,54 +143,24 @@ function [out, line_ctr] = parse_header(str, line_ctr, linefeeds, has_backr)
     end
 end
 
-function [markernum, messages, blink_l, blink_r, sacc_l, sacc_r] = parse_events(str, linefeeds, has_backr, header_struct)
-    linebeg_indices = linefeeds(1: end - 1) + 1;
-    linebegs = str(linebeg_indices);
-
-    marker_str = concatenate_separate_event_lines(str, find(linebegs == 'U'), linefeeds);
-    blink_str = concatenate_separate_event_lines(str, find(linebegs == 'B'), linefeeds);
-    sacc_str = concatenate_separate_event_lines(str, find(linebegs == 'S'), linefeeds);
-
-    blink_left_mask = find_lefteye_events(blink_str, 'Blink');
-    sacc_left_mask = find_lefteye_events(sacc_str, 'Saccade');
-
-    C = textscan(marker_str, header_struct.marker_fmt, ...
-        'Delimiter', '\t', ...
-        'CollectOutput', 1);
+function [markernum, messages, blink_l, blink_r, sacc_l, sacc_r] = parse_events(str, line_ctr, header_struct)
+    % route the event lines by their leading tag, left eye events first, and
+    % parse each event type with one textscan call
+    opts = {'Delimiter', '\t', 'CollectOutput', 1};
+    routes = struct( ...
+        'pattern', {'Blink L', 'B', 'Saccade L', 'S', 'U'}, ...
+        'format', {header_struct.blink_fmt, header_struct.blink_fmt, ...
+            header_struct.sacc_fmt, header_struct.sacc_fmt, header_struct.marker_fmt}, ...
+        'options', {opts, opts, opts, opts, opts});
+    [~, lines] = pspm_route_lines(str, routes, line_ctr);
+
+    blink_l = lines.route(1).data{1};
+    blink_r = lines.route(2).data{1};
+    sacc_l = lines.route(3).data{1};
+    sacc_r = lines.route(4).data{1};
+    C = lines.route(5).data;
     markernum = C{1};
     messages = C{2};
-
-    C = textscan(blink_str, header_struct.blink_fmt, ...
-        'Delimiter', '\t', ...
-        'CollectOutput', 1);
-    blinknum = C{1};
-    blink_l = blinknum(blink_left_mask, :);
-    blink_r = blinknum(~blink_left_mask, :);
-
-    C = textscan(sacc_str, header_struct.sacc_fmt, ...
-        'Delimiter', '\t', ...
-        'CollectOutput', 1);
-    saccnum = C{1};
-    sacc_l = saccnum(sacc_left_mask, :);
-    sacc_r = saccnum(~sacc_left_mask, :);
-end
-
-function leftmask = find_lefteye_events(str, event_name)
-    n_to_the_right = numel(event_name) + 1;
-    linefeeds = [0, strfind(str, sprintf('\n'))];
-    linebegs = linefeeds(1 : end - 1) + 1;
-    eye_chars = str(linebegs + n_to_the_right);
-    leftmask = eye_chars == 'L';
-end
-
-function events_concat = concatenate_separate_event_lines(str, line_indices, linefeeds)
-    char_indices = false(numel(str), 1);
-    for i = 1:numel(line_indices)
-        begidx = linefeeds(line_indices(i)) + 1;
-        endidx = linefeeds(line_indices(i) + 1);
-        char_indices(begidx : endidx) = true;
-    end
-    events_concat = str(char_indices);
 end
 
 function linestr = readline(str, linefeeds, line_ctr, has_backr)
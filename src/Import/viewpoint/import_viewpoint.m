@@ -36,8 +36,6 @@ function [data] = import_viewpoint(filepath)
 %   Function inspired by GazeAlyze.
 %   Most parts rewritten by Eshref Yozdemir to handle newer ViewPoint files.
 
-bsearch_path = pspm_path('ext', 'bsearch');
-addpath(bsearch_path);
 if ~exist(filepath,'file')
   error('ID:invalid_input', 'Passed file does not exist.');
 end
@@ -81,7 +79,6 @@ for sn = 1:numel(sess_beg_indices) - 1
   data{sn}.marker.pos = nonempty_indices;
   data{sn}.marker.times = data{sn}.channels(nonempty_indices, 1);
 end
-rmpath(bsearch_path);
 end
 
 function [dataraw, marker, messages, chan_info, file_info] = parse_viewpoint_file(filepath)
@@ -100,22 +97,19 @@ if any(strncmp(column_ids, 'B', numel('B')))
 end
 
 [col_idx, channel_header, channel_units] = pspm_chans_in_file(column_ids, eyesObserved);
-[msg_linenums, messages] = get_msg_lines(str, linefeeds, has_backr);
-
-linefeeds = linefeeds(line_ctr : end);
-str = str(linefeeds(1) + 1 : end);
-msg_linenums = msg_linenums - line_ctr + 1;
-linefeeds = linefeeds - linefeeds(1);
-
 [read_numeric_columns, fmt_str] = get_columns_to_read(column_ids);
 
-for msg_line = msg_linenums
-  begidx = linefeeds(msg_line) + 1;
-  str(begidx : begidx + 1) = '/';
-end
-C = textscan(str, fmt_str, 'CollectOutput', 1, 'CommentStyle', '//');
+% data lines (tag 10) are parsed in one go, all other lines after the
+% header are messages
+routes = struct('pattern', {'10\t', ''}, ...
+  'format', {fmt_str, ''}, ...
+  'options', {{'CollectOutput', 1}, {}});
+[~, lines] = pspm_route_lines(str, routes, line_ctr);
+C = lines.route(1).data;
 dataraw = C{1};
 marker = C{2};
+messages = lines.route(2).data;
+messages = messages(~cellfun(@isempty, messages));
 
 file_info.columns = columns;
 file_info.column_ids = column_ids;
@@ -210,26 +204,6 @@ for which_eye = eyesObserved
 end
 end
 
-function [msg_linenums, messages] = get_msg_lines(str, linefeeds, has_backr)
-data_beg_indices = strfind(str, sprintf('\n10\t'));
-datalines = [bsearch(linefeeds, data_beg_indices), numel(linefeeds)];
-n_message_lines = max(0, diff(datalines) - 1);
-datalines_msg_beg_indices = find(n_message_lines > 0);
-msg_beg_lines = int32(datalines(datalines_msg_beg_indices) + 1);
-msg_end_lines = int32(datalines(datalines_msg_beg_indices) + n_message_lines(datalines_msg_beg_indices));
-msg_linenums = [];
-for i = 1:numel(msg_beg_lines)
-  msg_linenums(end + 1 : end + 1 + msg_end_lines(i) - msg_beg_lines(i)) = msg_beg_lines(i) : msg_end_lines(i);
-end
-
-messages = {};
-for msg_line = msg_linenums
-  begidx = linefeeds(msg_line) + 1;
-  endidx = linefeeds(msg_line + 1) - 1 - has_backr;
-  messages{end + 1} = str(begidx : endidx);
-end
-end
-
 function [read_numeric_columns, fmt_str] = get_columns_to_read(column_ids)
 read_numeric_columns = ['TYPE'; column_ids];
 fmt_array = cell(1, numel(read_numeric_columns));
@@ -255,49 +229,50 @@ end
 
 function [channels, marker, chan_info] = parse_messages(messages, channels, marker, chan_info, eyesObserved)
 has_messages = ~isempty(messages);
-tab = sprintf('\t');
 if has_messages
   blinks_A = false(size(channels, 1), 1);
   blinks_B = false(size(channels, 1), 1);
   saccades_A = false(size(channels, 1), 1);
   saccades_B = false(size(channels, 1), 1);
   timecol = channels(:, 1);
-  for msgline = messages
-    parts = split(msgline, tab);
-    msg_type = str2num(parts{1});
-    if msg_type == 2 || msg_type == 12
-      timestamp = str2double(parts{2});
-      msg = parts{3};
-      insert_idx = bsearch(timecol, timestamp);
-      if timecol(insert_idx) == timestamp
-        marker{insert_idx} = msg;
-      end
-    elseif msg_type == 14
-      continue;
-    elseif (contains(msgline, 'Saccade') || ...
-        contains(msgline, 'Blink')) && ...
-        ~isempty(regexp(msgline,'sec$'))
-      timestamp = str2double(parts{2});
-      msg = parts{3};
-      forbeg_idx = strfind(msg, ' for ');
-      secbeg_idx = forbeg_idx + strfind(msg(forbeg_idx + 1 : end), ' ') + 1;
-      secend_idx = secbeg_idx + strfind(msg(secbeg_idx + 1 : end), ' ') - 1;
-      duration = str2double(msg(secbeg_idx : secend_idx));
-      beg_timestamp = round(timestamp - duration, 4);
+  % tokenise all message lines at once: type, timestamp and message text
+  parts = regexp(messages(:), '^([^\t]*)\t([^\t]*)\t([^\t]*)', 'tokens', 'once');
+  parts(cellfun(@isempty, parts)) = {{'', '', ''}};
+  parts = vertcat(parts{:});
+  msg_type = str2double(parts(:, 1));
+  timestamp = str2double(parts(:, 2));
+  msg = parts(:, 3);
 
-      index_of_beg_timestamp = bsearch(timecol, beg_timestamp);
-      index_of_curr_timestamp = bsearch(timecol, timestamp);
+  % markers are only kept if they coincide with a sample
+  is_marker = find(msg_type == 2 | msg_type == 12);
+  if ~isempty(is_marker)
+    insert_idx = pspm_bsearch(timecol, timestamp(is_marker));
+    insert_idx = insert_idx(:);
+    exact = timecol(insert_idx) == timestamp(is_marker);
+    marker(insert_idx(exact)) = msg(is_marker(exact));
+  end
 
-      if contains(msgline, 'A:Saccade')
-        saccades_A(index_of_beg_timestamp : index_of_curr_timestamp) = true;
-      elseif contains(msgline, 'B:Saccade')
-        saccades_B(index_of_beg_timestamp : index_of_curr_timestamp) = true;
-      elseif contains(msgline, 'A:Blink')
-        blinks_A(index_of_beg_timestamp : index_of_curr_timestamp) = true;
-      else
-        blinks_B(index_of_beg_timestamp : index_of_curr_timestamp) = true;
-      end
-    end
+  % saccades and blinks are reported at their end, with their duration
+  is_event = find(msg_type ~= 2 & msg_type ~= 12 & msg_type ~= 14 & ...
+    (contains(messages(:), 'Saccade') | contains(messages(:), 'Blink')) & ...
+    ~cellfun(@isempty, regexp(messages(:), 'sec$', 'once')));
+  if ~isempty(is_event)
+    duration = regexp(msg(is_event), ' for (\S+)', 'tokens', 'once');
+    duration(cellfun(@isempty, duration)) = {{''}};
+    duration = str2double([duration{:}]');
+    beg_timestamp = round(timestamp(is_event) - duration, 4);
+    event_idx = pspm_bsearch(timecol, [beg_timestamp; timestamp(is_event)]);
+    index_of_beg_timestamp = event_idx(1 : numel(is_event));
+    index_of_curr_timestamp = event_idx(numel(is_event) + 1 : end);
+    is_sacc_A = contains(messages(is_event), 'A:Saccade');
+    is_sacc_B = ~is_sacc_A & contains(messages(is_event), 'B:Saccade');
+    is_blink_A = ~is_sacc_A & ~is_sacc_B & contains(messages(is_event), 'A:Blink');
+    is_blink_B = ~is_sacc_A & ~is_sacc_B & ~is_blink_A;
+    n = numel(timecol);
+    saccades_A = pspm_intervals('to_logical', [index_of_beg_timestamp(is_sacc_A), index_of_curr_timestamp(is_sacc_A) + 1], n);
+    saccades_B = pspm_intervals('to_logical', [index_of_beg_timestamp(is_sacc_B), index_of_curr_timestamp(is_sacc_B) + 1], n);
+    blinks_A = pspm_intervals('to_logical', [index_of_beg_timestamp(is_blink_A), index_of_curr_timestamp(is_blink_A) + 1], n);
+    blinks_B = pspm_intervals('to_logical', [index_of_beg_timestamp(is_blink_B), index_of_curr_timestamp(is_blink_B) + 1], n);
   end
   curr_n_cols = size(channels, 2);
   channels(:, curr_n_cols + 1) = blinks_A;
@@ -66,6 +66,9 @@ switch flag
                     fname = @VBA_Iphi_split;
                 elseif options.binomial
                     fname = @VBA_Iphi_binomial;
+                elseif isfield(options,'Iphi_fname') && ~isempty(options.Iphi_fname)
+                    % alternative backend for the same update (see pspm_dcm_iphi)
+                    fname = options.Iphi_fname;
                 else
                     fname = @VBA_Iphi;
                 end
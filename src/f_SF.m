@@ -17,63 +17,22 @@ function [fx, dfdx, dfdP] = f_SF(Xt, Theta, ut, in)
 %           2 value  per SF (time, log(amplitude))
 %      ut:  row 1 - time (after cue onset)
 %           row 2 - number of SF
+% ● Developer's notes
+%   The model is implemented in pspm_dcm_integrate, which also integrates
+%   whole trajectories in one call.
 % ● History
 %   Introduced in PsPM 3.0
 %   Written in 2008-2015 by Dominik R Bach (Wellcome Trust Centre for Neuroimaging)
 
-%% initialise
-global settings;
-if isempty(settings), pspm_init; end;
-% settings
-Theta_n = 3;  % number of parameters for the peripheral function (the rest is for the neural function)
-try
-    dt = in.dt;
-catch
-    dt = 0.1;
+%% evaluate one time step
+if nargin < 4
+    in = struct();
 end
-try
-    sigma = in.sigma;  % std for event-related sudomotor input function
-catch
-    sigma = 0.3;
-end
-Xt = Xt(:);
-Theta = Theta(:)';
-% unpack parameters
-Theta = Theta(:)';
-if ut(2) > 0
-    for n = 1:ut(2)
-        sfTheta(n, 1) = Theta((n - 1) * 2 + Theta_n + 1);
-        sfTheta(n, 2) = sigma;
-        sfTheta(n, 3) = exp(Theta((n - 1) * 2 + Theta_n + 2));
-    end;
-else
-    sfTheta = [];
-end;
-% ODE 3rd order + gaussian
-xdot = [Xt(2)
-        Xt(3)
-        - Theta(1:3) * Xt(1:3) + gu(ut(1), sfTheta, 1)];
-fx = Xt + dt .* xdot;
-J = [0 1 0
-     0 0 1
-     -Theta(1:3)];
-dfdx = (dt .* J + eye(3))';
-Jp = zeros(numel(Xt), numel(Theta));
-Jp(3, 1:3) = -Xt;
-Jp(3, 4:2:numel(Theta)) = gu(ut(1), sfTheta, 0) .* 1./(sigma.^2) .* (ut(1) - sfTheta(:, 1));
-Jp(3, 5:2:numel(Theta)) = gu(ut(1), sfTheta, 0);
-dfdP = dt .* Jp';
-function [gu] = gu(ut, theta, f)
-if ~isempty(theta)
-    ut       = repmat(ut, size(theta, 1), 1);
-    mu       = theta(:, 1);
-    sigma    = theta(:, 2);
-    a        = theta(:, 3);
-    gu = a .* exp(-(ut - mu).^2 ./ (2 .* sigma.^2));
-    if f
-        gu = sum(gu);
-    end;
+if nargout > 2
+    [sts, Xt, dfdx, dfdP] = pspm_dcm_integrate('f_SF', Xt, Theta, ut(:, 1), in);
 else
-    gu = 0;
-end;
-return;
\ No newline at end of file
+    [sts, Xt, dfdx] = pspm_dcm_integrate('f_SF', Xt, Theta, ut(:, 1), in);
+    dfdP = [];
+end
+if sts < 1, error('Invalid input to f_SF'); end
+fx = Xt(:, 2);
@@ -0,0 +1,104 @@
+function index = pspm_bsearch(x, q, mode)
+% ● Description
+%   pspm_bsearch finds, for each query value, the index of the nearest
+%   element of a sorted vector. It is used by the importers to map event
+%   times onto the sample grid, and replaces ext/bsearch.
+% ● Format
+%   index = pspm_bsearch(x, q)
+%   index = pspm_bsearch(x, q, mode)
+% ● Arguments
+%   *     x : [numeric vector] sorted in ascending or descending order.
+%   *     q : [numeric array] query values, sorted or unsorted.
+%   *  mode : [char] [optional]
+%             'nearest' (default): index of the element closest to each
+%             query; queries outside the range of x map to its first or
+%             last element. If two elements are equally close, the one
+%             that comes first in ascending order is returned.
+%             'floor': index of the largest element smaller than or equal
+%             to each query, 0 if there is none.
+%             'ceil': index of the smallest element larger than or equal
+%             to each query, numel(x) + 1 if there is none.
+%             For descending x, indices refer to the original order, such
+%             that the empty result of 'floor' is numel(x) + 1 and that
+%             of 'ceil' is 0.
+% ● Output
+%   * index : [double] array of the same size as q. NaN for NaN queries.
+% ● Developer's notes
+%   The index of the floor of each query is the number of grid elements
+%   smaller than or equal to it. For few queries, it is found by a binary
+%   search that halves the interval of all queries at once, which takes
+%   O(m log n) time. For many queries, the grid is merged with the queries
+%   in one stable sort instead, and the number of grid elements that
+%   precede a query in the merged order is counted, which takes
+%   O((n + m) log(n + m)) time regardless of the order of the queries. If x
+%   contains repeated values, 'floor' and 'nearest' return the last and
+%   'ceil' the first of them in ascending order.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+index = [];
+if nargin < 2
+  warning('ID:invalid_input', 'Not enough input arguments.'); return;
+end
+if nargin < 3
+  mode = 'nearest';
+end
+if ~isnumeric(x) || isempty(x) || ~isvector(x) || ~isnumeric(q)
+  warning('ID:invalid_input', 'x must be a non-empty numeric vector and q numeric.'); return;
+end
+if ~any(strcmpi(mode, {'nearest', 'floor', 'ceil'}))
+  warning('ID:invalid_input', 'mode must be ''nearest'', ''floor'' or ''ceil''.'); return;
+end
+n = numel(x);
+x = double(x(:));
+shape = size(q);
+q = double(q(:));
+descending = x(1) > x(n);
+if descending
+  x = flipud(x);
+end
+
+%% Locate floor of queries
+n_steps = ceil(log2(n + 1));
+if numel(q) * n_steps < n + numel(q)
+  % binary search, with x(lo) <= q < x(hi) for x(0) = -Inf, x(n + 1) = Inf
+  lo = zeros(numel(q), 1);
+  hi = repmat(n + 1, numel(q), 1);
+  for k = 1:n_steps
+    active = find(hi - lo > 1);
+    mid = floor((lo(active) + hi(active)) / 2);
+    le = x(mid) <= q(active);
+    lo(active(le)) = mid(le);
+    hi(active(~le)) = mid(~le);
+  end
+else
+  % merge queries into the grid; grid elements come first, so that they
+  % precede equal queries in the stable sort
+  [~, order] = sort([x; q]);
+  is_grid = order <= n;
+  n_before = cumsum(is_grid);
+  lo = zeros(numel(q), 1);
+  lo(order(~is_grid) - n) = n_before(~is_grid);
+end
+
+%% Select index
+switch lower(mode)
+  case 'floor'
+    index = lo;
+  case 'ceil'
+    exact = lo > 0 & x(max(lo, 1)) == q;
+    index = lo + ~exact;
+  case 'nearest'
+    lo_clamped = max(lo, 1);
+    hi = min(lo + 1, n);
+    index = lo_clamped;
+    use_hi = abs(x(hi) - q) < abs(x(lo_clamped) - q);
+    index(use_hi) = hi(use_hi);
+end
+if descending
+  index = n - index + 1;
+end
+index(isnan(q)) = NaN;
+index = reshape(index, shape);
+return
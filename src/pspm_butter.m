@@ -1,15 +1,29 @@
-function [sts, b, a] = pspm_butter(order, freqratio, pass)
+function [sts, b, a] = pspm_butter(order, freqratio, pass, form)
 % ● Description
 %   pspm_butter interfaces Matlab Signal Processing Toolbox filters and
 %   additionally implements a few standard filters for those who don''t have
-%   this toolbox
+%   this toolbox. Filters in second-order section form are designed
+%   natively for any order and cut-off frequency.
 % ● Format
 %   [sts, b, a] = pspm_butter(order, freqratio)
+%   [sts, b, a] = pspm_butter(order, freqratio, pass)
+%   [sts, sos, g] = pspm_butter(order, freqratio, pass, 'sos')
 % ● Arguments
 %   *     order: the order of the Butterworth filter to be designed
 %   * freqratio: the cut-off frequency of the Butterworth filter to be designed
+%   *      pass: 'low' (default) or 'high'
+%   *      form: 'tf' (default) returns the transfer function coefficients b
+%                and a; 'sos' returns second-order sections, one row
+%                [b0 b1 b2 1 a1 a2] per section, and the gain g (always 1,
+%                as the gain is folded into the sections)
 % ● Output
 %   *       sts: -1 if non-standard filters are requested
+% ● Developer's notes
+%   Second-order sections are obtained by a bilinear transform of the
+%   analog Butterworth prototype, one conjugate pole pair at a time, with
+%   the cut-off frequency prewarped. Sections are ordered by increasing
+%   pole radius. The transfer function form becomes numerically unstable
+%   for high orders and low cut-off frequencies, the section form does not.
 % ● History
 %   Introduced in PsPM 3.0
 %   Written in 2009-2015 by Dominik R Bach (Wellcome Trust Centre for Neuroimaging)
@@ -31,6 +45,22 @@ elseif nargin < 3
 elseif ~(any(strcmpi(pass, {'high', 'low'})))
   warning('ID:invalid_input','%s is not a valid argument.', pass); return;
 end;
+if nargin < 4
+  form = 'tf';
+elseif ~(any(strcmpi(form, {'tf', 'sos'})))
+  warning('ID:invalid_input','%s is not a valid argument.', form); return;
+end
+if strcmpi(form, 'sos')
+  if ~isnumeric(order) || ~isscalar(order) || order < 1 || order ~= round(order)
+    warning('ID:invalid_input','Filter order must be a positive integer.'); return;
+  elseif ~isnumeric(freqratio) || ~isscalar(freqratio) || freqratio <= 0 || freqratio >= 1
+    warning('ID:invalid_input','Frequency ratio must be between 0 and 1.'); return;
+  end
+  b = butter_sos(order, freqratio, strcmpi(pass, 'high'));
+  a = 1;
+  sts = 1;
+  return
+end
 
 if ~settings.signal && order ~= 1
   warning('ID:toolbox_missing','This function can only create 1st order filters - %s', errmsg); return;
@@ -76,3 +106,30 @@ return
 %     filt{2}(n).freqratio = freqratio(n);
 % end;
 % save([settings.path, 'pspm_butter.mat'], 'filt');
+
+function sos = butter_sos(order, freqratio, highpass)
+K = tan(pi * freqratio / 2);
+sos = zeros(ceil(order / 2), 6);
+row = 1;
+% one section per conjugate pole pair, most damped first
+for k = floor(order / 2):-1:1
+  zeta = sin(pi * (2 * k - 1) / (2 * order));
+  a = [1 + 2 * zeta * K + K^2, 2 * K^2 - 2, 1 - 2 * zeta * K + K^2];
+  if highpass
+    b = [1, -2, 1];
+  else
+    b = K^2 * [1, 2, 1];
+  end
+  sos(row, :) = [b, a] / a(1);
+  row = row + 1;
+end
+% real pole of odd orders
+if mod(order, 2)
+  a = [1 + K, K - 1, 0];
+  if highpass
+    b = [1, -1, 0];
+  else
+    b = K * [1, 1, 0];
+  end
+  sos(row, :) = [b, a] / a(1);
+end
@@ -7,7 +7,11 @@ function [sts,outchannel,debug_info] = pspm_convert_ecg2hb(fn, options)
 % ● Format
 %   [sts, channel_index, quality_info] = pspm_convert_ecg2hb(fn, options)
 % ● Arguments
-%   *            fn : data file name
+%   *            fn : data file name, or cell array of data file names to
+%                     process several files with the same options. In this
+%                     case, channel_index and quality_info are cell arrays
+%                     with one element per file, and sts is 1 only if all
+%                     files were processed successfully.
 %   ┌───────options
 %   ├──────.channel : [optional, numeric/string, default: 'ecg', i.e. last ECG channel
 %   │                 in the file] Channel type or channel ID to be preprocessed.
@@ -107,6 +111,12 @@ function [sts,outchannel,debug_info] = pspm_convert_ecg2hb(fn, options)
 %
 %   R:            Vector of the same length as the raw data, containing
 %                 information on the position of the QRS complexes.
+%   ▶︎ Implementation
+%   The sliding window integrator is computed with filter. find_r visits
+%   only candidate peaks of the amplified signal, jumping over the samples
+%   between them with a precomputed index of the next peak, and twave_check
+%   and tmax only look at the most recent R-R intervals, so that the run
+%   time is linear in the recording length.
 
 %% Initialise
 global settings
@@ -123,6 +133,19 @@ if nargin < 1
 elseif nargin < 2
   options = struct();
 end
+if iscell(fn)
+  % process each file with the same options
+  outchannel = cell(size(fn));
+  debug_info = cell(size(fn));
+  fsts = zeros(size(fn));
+  for i_fn = 1:numel(fn)
+    [fsts(i_fn), outchannel{i_fn}, debug_info{i_fn}] = pspm_convert_ecg2hb(fn{i_fn}, options);
+  end
+  if all(fsts == 1)
+    sts = 1;
+  end
+  return
+end
 options = pspm_options(options, 'convert_ecg2hb');
 if options.invalid
   return
@@ -182,10 +205,8 @@ pt.data.x(:,2)=pt.data.x(:,2).^2;
 
 % --Sliding Window Integrator----------------------------------------------
 pt.settings.q=round(pt.settings.filt.sr/6.66667);
-pt.data.x(:,3)=pt.data.x(:,2);
-for j=(pt.settings.q+1):pt.settings.n
-  pt.data.x(j,3)=(1/pt.settings.q)*(sum(pt.data.x((j-pt.settings.q):j,2)));
-end
+pt.data.x(:,3)=filter(ones(pt.settings.q+1,1)/pt.settings.q,1,pt.data.x(:,2));
+pt.data.x(1:min(pt.settings.q,pt.settings.n),3)=pt.data.x(1:min(pt.settings.q,pt.settings.n),2);
 
 % --Find peaks-------------------------------------------------------------
 pt.data.pt_peaks=zeros(length(pt.data.x),2);
@@ -296,6 +317,10 @@ cse=1;
 pt.set.rc=1;
 pt.set.twave='negative';
 pt.set.grad=gradient(pt.data.x(:,2));
+% index of the next candidate peak at or after each sample
+nextpeak=(1:pt.settings.n+1)';
+nextpeak([pt.data.pt_peaks(:,1)==0; false])=pt.settings.n+1;
+nextpeak=cummin(nextpeak,1,'reverse');
 CSE(1,:)='SPKI%d';
 CSE(2,:)='SPKF%d';
 % -------------------------------------------------------------------------
@@ -323,7 +348,8 @@ while pt.set.tstart+pt.set.tmax <= pt.settings.n
         % ---------------------------------------------------------
         % no peak at this point
       elseif pt.data.pt_peaks(j,1) == 0
-        j = j + 1;
+        % skip to the next peak, without passing the end of the interval
+        j = max(j + 1, min([nextpeak(j), pt.set.tstart + pt.set.tmax, pt.settings.n]));
         % ---------------------------------------------------------
         % R peak at this point
       elseif pt.data.pt_peaks(j,1) >= (pt.set.THRF/cse) && max(pt.data.pt_peaks(invl2,2)) >= (pt.set.THRI/cse)  ...
@@ -464,19 +490,21 @@ else
 end
 
 % ---Get average 2---------------------------------------------------------
-
-Rcur=diff(pt.set.R);
-
-for j=1:length(Rcur)
-
-  if  Rcur(j) < 0.92 * av2 || Rcur(j) > 1.16 * av2
-    Rcur(j)=0;
+% average of the last 8 R-R intervals within 92-116% of av2, if there are
+% more than 8 such intervals; only as many recent intervals as needed are
+% inspected
+nR=length(pt.set.R);
+span=16;
+while true
+  Rcur=diff(pt.set.R(max(1,nR-span):nR));
+  Rcor=Rcur(Rcur ~= 0 & Rcur >= 0.92 * av2 & Rcur <= 1.16 * av2);
+  if length(Rcor) > 8
+    av2=mean(Rcor((length(Rcor)-7):length(Rcor)));
+    break
+  elseif span >= nR-1
+    break
   end
-end
-
-if length(Rcur(Rcur~=0)) > 8
-  Rcor=Rcur(Rcur ~=0);
-  av2=mean(Rcor((length(Rcor)-7):length(Rcor)));
+  span=2*span;
 end
 
 
@@ -493,9 +521,9 @@ end
 function [twave]=twave_check(pt,j)
 % -------------------------------------------------------------------------
 
-q=diff(pt.set.R);
+nR=length(pt.set.R);
 
-if ~isempty(q) && q(end) < pt.settings.filt.sr * pt.settings.twthresh
+if nR > 1 && pt.set.R(nR)-pt.set.R(nR-1) < pt.settings.filt.sr * pt.settings.twthresh
   if pt.set.grad(j) < 0.5 * pt.set.grad(pt.set.R(end-1))
     twave='positive';
   else
@@ -116,6 +116,22 @@ function [sts, dcm] = pspm_dcm(model, options)
 %   ├.aSCR_sigma_offset:
 %   │             Minimum dispersion (standard deviation) for flexible
 %   │             responses, in seconds. Default: 0.1 s.
+%   ├──.parallel: [0/1] Invert the trial windows on the workers of a
+%   │             parallel pool (Parallel Computing Toolbox), starting
+%   │             later trial windows from speculative initial states and
+%   │             priors which are checked and, where necessary, refined
+%   │             after each round. The results equal those of the
+%   │             sequential inversion within .speculative_tol.
+%   │             Default: 0.
+%   ├.speculative_tol:
+%   │             Tolerance on the relative difference between
+%   │             speculative and exact initial states and priors, above
+%   │             which a trial window is inverted again. Default: 1e-3.
+%   ├.vb_backend: ['vba'/'pspm'] Gauss-Newton update of the VB inversion.
+%   │             'pspm' uses pspm_dcm_iphi, a faster implementation of
+%   │             the update for the SCR model with the same results.
+%   │             pspm_sf_dcm has the same option for the SF model.
+%   │             Default: 'vba'.
 %   ├─.dispwin:   [0/1] Display progress plot. Default: display.
 %   ├─.dispsmallwin: [0/1]
 %   │             Display intermediate progress plots.
@@ -212,10 +228,10 @@ end
 % all the below should be re-factored into pspm_options -------------------
 % numeric fields
 num_fields = {'depth', 'sfpre', 'sfpost', 'sffreq', 'sclpre', ...
-  'sclpost', 'aSCR_sigma_offset'};
+  'sclpost', 'aSCR_sigma_offset', 'speculative_tol'};
 % logical fields
 bool_fields = {'crfupdate', 'indrf', 'getrf', 'dispwin', ...
-  'dispsmallwin', 'nosave'};
+  'dispsmallwin', 'nosave', 'parallel'};
 % cell fields
 cell_fields = {'trlnames', 'eventnames'};
 check_sts = sum([pspm_dcm_check_options('numeric', options, num_fields), ...
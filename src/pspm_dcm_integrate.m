@@ -0,0 +1,307 @@
+function [sts, Xt, dfdx, dfdP] = pspm_dcm_integrate(f_fname, X0, Theta, ut, in)
+% ● Description
+%   pspm_dcm_integrate evaluates the evolution functions of the SCR and SF
+%   models, f_SCR and f_SF, over a whole input sequence in one call. The
+%   parameters are unpacked once, the sudomotor input is computed for all
+%   time steps at once, and the Jacobians are returned analytically for
+%   every time step. f_SCR and f_SF call this function for a single time
+%   step.
+% ● Format
+%   [sts, Xt, dfdx, dfdP] = pspm_dcm_integrate(f_fname, X0, Theta, ut, in)
+% ● Arguments
+%   * f_fname : [char] 'f_SCR' or 'f_SF'.
+%   *      X0 : [vector] initial state, 7 states for f_SCR and 3 for f_SF.
+%   *   Theta : [vector] evolution parameters as described in f_SCR and
+%               f_SF.
+%   *      ut : [matrix] input as described in f_SCR and f_SF, one column
+%               per time step.
+%   *      in : [struct] [optional] with field .dt (integration time step)
+%               and, for f_SF, .sigma. Defaults are those of f_SCR and f_SF.
+% ● Output
+%   *      Xt : [matrix] states x (time steps + 1) trajectory, starting with
+%               X0, such that Xt(:, k + 1) is the evolution function of
+%               Xt(:, k) and ut(:, k).
+%   *    dfdx : [matrix] states x states Jacobian with respect to the
+%               states, in the transposed VBA convention. It is the same
+%               for all time steps.
+%   *    dfdP : [array] parameters x states x time steps Jacobian with
+%               respect to the parameters, in the transposed VBA convention.
+%               For an empty input sequence, Xt is X0 and dfdP is empty.
+% ● Developer's notes
+%   Both models are Euler steps of linear ODEs driven by Gaussian bumps
+%   whose timing and amplitude depend only on the parameters and on rows 2
+%   and below of ut. Time steps are grouped by these rows, the parameters
+%   are unpacked once per group, and the bumps and their derivatives are
+%   computed for all time steps of the group together. Only the linear
+%   recursion runs over time steps.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+global settings
+if isempty(settings)
+  pspm_init;
+end
+sts = -1;
+Xt = [];
+dfdx = [];
+dfdP = [];
+if nargin < 4
+  warning('ID:invalid_input', 'Not enough input arguments.'); return;
+elseif nargin < 5
+  in = struct();
+end
+switch f_fname
+  case 'f_SCR'
+    n_states = 7;
+    dt = 1;
+  case 'f_SF'
+    n_states = 3;
+    dt = 0.1;
+  otherwise
+    warning('ID:invalid_input', 'Unknown evolution function ''%s''.', f_fname); return;
+end
+if isfield(in, 'dt')
+  dt = in.dt;
+end
+if isfield(in, 'sigma')
+  sigma = in.sigma;
+else
+  sigma = 0.3;
+end
+X0 = X0(:);
+Theta = Theta(:)';
+if numel(X0) ~= n_states
+  warning('ID:invalid_input', '%s has %d states.', f_fname, n_states); return;
+end
+n_steps = size(ut, 2);
+with_dfdP = nargout > 3;
+
+%% Sudomotor input
+% group time steps with the same events
+if n_steps == 1
+  first = 1;
+  group = 1;
+else
+  [~, first, group] = unique(ut(2:end, :)', 'rows', 'stable');
+end
+G = zeros(n_states, n_steps);
+if with_dfdP
+  Jp = zeros(n_states, numel(Theta), n_steps);
+end
+% ODE parameters, which do not depend on the input
+Theta_ode = Theta;
+if strcmp(f_fname, 'f_SCR')
+  Theta_ode(1:4) = exp(Theta(1:4));
+end
+for i_group = 1:numel(first)
+  if n_steps == 1
+    cols = 1;
+  else
+    cols = find(group == i_group)';
+  end
+  if strcmp(f_fname, 'f_SCR')
+    [~, G(:, cols), Jp_group] = scr_input(Theta, ut(:, first(i_group)), ut(1, cols), ...
+      settings.dcm{1}.sigma_offset, with_dfdP);
+  else
+    [G(:, cols), Jp_group] = sf_input(Theta, ut(:, first(i_group)), ut(1, cols), sigma, with_dfdP);
+  end
+  if with_dfdP
+    Jp(:, :, cols) = Jp_group;
+  end
+end
+
+%% Integrate
+if strcmp(f_fname, 'f_SCR')
+  J = [0 1 0            0 0 0            0
+       0 0 1            0 0 0            0
+       -Theta_ode(1:3)  0 0 0            0
+       0 0 0            0 1 0            0
+       0 0 0            0 0 1            0
+       0 0 0            -Theta_ode(5:7)  0
+       0 0 0            0 0 0            0];
+else
+  J = [0 1 0
+       0 0 1
+       -Theta_ode(1:3)];
+end
+Xt = zeros(n_states, n_steps + 1);
+Xt(:, 1) = X0;
+for k = 1:n_steps
+  Xt(:, k + 1) = Xt(:, k) + dt .* (J * Xt(:, k) + G(:, k));
+end
+dfdx = (dt .* J + eye(n_states))';
+
+%% Jacobian with respect to the parameters
+if with_dfdP
+  % the ODE parameters enter through the states
+  if strcmp(f_fname, 'f_SCR')
+    Jp(3, 1:3, :) = reshape(bsxfun(@times, -Xt(1:3, 1:n_steps), Theta_ode(1:3)'), [1, 3, n_steps]);
+    Jp(6, 5:7, :) = reshape(-Xt(4:6, 1:n_steps), [1, 3, n_steps]);
+  else
+    Jp(3, 1:3, :) = reshape(-Xt(:, 1:n_steps), [1, 3, n_steps]);
+  end
+  dfdP = dt .* permute(Jp, [2, 1, 3]);
+end
+sts = 1;
+return
+
+function [Theta, G, Jp] = scr_input(Theta, ut, t, sigma_offset, with_dfdP)
+% sudomotor input of f_SCR at times t for the events in ut, and its
+% derivatives with respect to the parameters
+sigma = 0.3;      % std for event-related and spontaneous sudomotor input function
+sigma_SCL = 1;    % std for SCL changes
+Theta_n = 7;      % number of parameters for the output function
+n_theta = numel(Theta);
+% ODE SCR parameters & eSCR delay
+Theta(1:4) = exp(Theta(1:4));
+% - anticipatory responses
+if ut(2) > 0
+  aSCR_o = 5 + (1:ut(2));             % aSCR onsets
+  aSCR_m = aSCR_o(end) + (1:ut(2));   % aSCR mean upper bound
+  aSCR_s = aSCR_m(end) + (1:ut(2));   % aSCR sigma upper bound
+  aTheta = reshape(Theta(Theta_n + (1:(3 * ut(2)))), [3, ut(2)])';
+  dmdx = NaN(ut(2), 1);
+  dsdx = NaN(ut(2), 1);
+  sig.beta = 0.5;
+  for k = 1:ut(2)
+    sig.G0 = ut(aSCR_m(k));
+    [m, dmdx(k)] = sigm(aTheta(k, 1), sig);
+    aTheta(k, 1) = ut(aSCR_o(k)) + m + Theta(4);  % onset plus mean plus physical delay (from eSCR)
+    sig.G0 = ut(aSCR_s(k));
+    [s, dsdx(k)] = sigm(aTheta(k, 2), sig);
+    aTheta(k, 2) = s + sigma_offset;
+    aTheta(k, 3) = exp(aTheta(k, 3));
+  end
+  aTheta(isinf(aTheta(:, 3)), 3) = 1e200; % an arbitrary value way below realmax
+else
+  aTheta = zeros(0, 3);
+  aSCR_s = 5;
+end
+% - event-related responses
+if ut(3) > 0
+  eSCR_o = aSCR_s(end) + (1:ut(3));   % eSCR onsets
+  eTheta = [ut(eSCR_o) + Theta(4), repmat(sigma, ut(3), 1), ...
+    exp(Theta((Theta_n + 3 * ut(2)) + (1:ut(3))))'];
+  eTheta(isinf(eTheta(:, 3)), 3) = 1e200;
+else
+  eTheta = zeros(0, 3);
+  eSCR_o = aSCR_s(end);
+end
+% - spontaneous fluctuations
+if ut(4) > 0
+  SF_lb = eSCR_o(end) + (1:ut(4));    % SF lower bound
+  SF_ub = SF_lb(end) + (1:ut(4));     % SF upper bound
+  sfTheta = zeros(ut(4), 3);
+  dtdx = NaN(ut(4), 1);
+  sig.beta = 0.5;
+  for k = 1:ut(4)
+    sig.G0 = ut(SF_ub(k)) - ut(SF_lb(k));
+    [tk, dtdx(k)] = sigm(Theta(Theta_n + 3 * ut(2) + ut(3) + (k - 1) * 2 + 1), sig);
+    sfTheta(k, 1) = ut(SF_lb(k)) + tk; % lower bound plus parameter value
+  end
+  sfTheta(:, 2) = sigma;
+  sfTheta(:, 3) = exp(Theta((Theta_n + 3 * ut(2) + ut(3)) + (2:2:(2 * ut(4)))));
+else
+  sfTheta = zeros(0, 3);
+  SF_ub = eSCR_o;
+end
+% - SCL changes
+if ut(5) > 0
+  SCL_lb = SF_ub(end) + (1:ut(5));
+  SCL_ub = SCL_lb(end) + (1:ut(5));
+  SCLtheta = zeros(ut(5), 3);
+  dtscldx = NaN(ut(5), 1);
+  sig.beta = 0.5;
+  for k = 1:ut(5)
+    sig.G0 = ut(SCL_ub(k)) - ut(SCL_lb(k));
+    [tk, dtscldx(k)] = sigm(Theta(Theta_n + 3 * ut(2) + ut(3) + 2 * ut(4) + (k - 1) * 2 + 1), sig);
+    SCLtheta(k, 1) = ut(SCL_lb(k)) + tk; % lower bound plus parameter value
+  end
+  SCLtheta(:, 2) = sigma_SCL;
+  SCLtheta(:, 3) = Theta((Theta_n + 3 * ut(2) + ut(3)) + 2 * ut(4) + (2:2:(2 * ut(5))));
+else
+  SCLtheta = zeros(0, 3);
+end
+
+% input: 3 states for ER, 3 states for SF, 1 state for SCL
+n_t = numel(t);
+ga = bumps(t, aTheta);
+ge = bumps(t, eTheta);
+gsf = bumps(t, sfTheta);
+gscl = bumps(t, SCLtheta);
+G = zeros(7, n_t);
+G(3, :) = sum([ge; ga], 1);
+G(6, :) = sum(gsf, 1);
+G(7, :) = sum(gscl, 1);
+
+% derivatives of the input, without the terms that depend on the states
+Jp = [];
+if ~with_dfdP
+  return
+end
+Jp = zeros(7, n_theta, n_t);
+if ut(2) > 0
+  ta = bsxfun(@minus, t, aTheta(:, 1));
+  Jp(3, Theta_n + (1:3:(3 * ut(2))), :) = ...
+    reshape(bsxfun(@times, ga .* ta, aTheta(:, 2).^-2 .* dmdx), [1, ut(2), n_t]);
+  Jp(3, Theta_n + (2:3:(3 * ut(2))), :) = ...
+    reshape(bsxfun(@times, ga .* ta.^2, aTheta(:, 2).^-3 .* dsdx), [1, ut(2), n_t]);
+  Jp(3, Theta_n + (3:3:(3 * ut(2))), :) = reshape(ga, [1, ut(2), n_t]);
+end
+if ut(3) > 0
+  Jp(3, (Theta_n + 3 * ut(2)) + (1:ut(3)), :) = reshape(ge, [1, ut(3), n_t]);
+end
+if ut(2) > 0 || ut(3) > 0
+  % the delay Theta(4) shifts all event-related and anticipatory bumps
+  allTheta = [eTheta; aTheta];
+  Jp(3, 4, :) = reshape(sum(bsxfun(@times, [ge; ga] .* bsxfun(@minus, t, allTheta(:, 1)), ...
+    1 ./ allTheta(:, 2).^2), 1) .* Theta(4), [1, 1, n_t]);
+end
+if ut(4) > 0
+  Jp(6, (Theta_n + 3 * ut(2) + ut(3)) + (1:2:(2 * ut(4))), :) = ...
+    reshape(bsxfun(@times, gsf .* bsxfun(@minus, t, sfTheta(:, 1)), sfTheta(:, 2).^-2 .* dtdx), ...
+    [1, ut(4), n_t]);
+  Jp(6, (Theta_n + 3 * ut(2) + ut(3)) + (2:2:(2 * ut(4))), :) = reshape(gsf, [1, ut(4), n_t]);
+end
+if ut(5) > 0
+  Jp(7, (Theta_n + 3 * ut(2) + ut(3)) + 2 * ut(4) + (1:2:(2 * ut(5))), :) = ...
+    reshape(bsxfun(@times, gscl .* bsxfun(@minus, t, SCLtheta(:, 1)), dtscldx ./ sigma_SCL.^2), ...
+    [1, ut(5), n_t]);
+  % amplitudes of SCL changes are not log transformed, so the derivative
+  % is the bump of unit amplitude
+  SCLtheta(:, 3) = 1;
+  Jp(7, (Theta_n + 3 * ut(2) + ut(3)) + 2 * ut(4) + (2:2:(2 * ut(5))), :) = ...
+    reshape(bumps(t, SCLtheta), [1, ut(5), n_t]);
+end
+return
+
+function [G, Jp] = sf_input(Theta, ut, t, sigma, with_dfdP)
+% sudomotor input of f_SF at times t for the events in ut, and its
+% derivatives with respect to the parameters
+Theta_n = 3;  % number of parameters for the peripheral function
+n_sf = ut(2);
+sfTheta = [Theta(Theta_n + (1:2:(2 * n_sf)))', repmat(sigma, n_sf, 1), ...
+  exp(Theta(Theta_n + (2:2:(2 * n_sf))))'];
+n_t = numel(t);
+gsf = bumps(t, sfTheta);
+G = zeros(3, n_t);
+G(3, :) = sum(gsf, 1);
+Jp = [];
+if ~with_dfdP
+  return
+end
+Jp = zeros(3, numel(Theta), n_t);
+if n_sf > 0
+  Jp(3, Theta_n + (1:2:(2 * n_sf)), :) = ...
+    reshape(gsf .* bsxfun(@minus, t, sfTheta(:, 1)) ./ sigma.^2, [1, n_sf, n_t]);
+  Jp(3, Theta_n + (2:2:(2 * n_sf)), :) = reshape(gsf, [1, n_sf, n_t]);
+end
+return
+
+function g = bumps(t, theta)
+% gaussian bumps with onset, std and amplitude in the rows of theta, one
+% row per bump and one column per time point
+g = bsxfun(@times, theta(:, 3), exp(-bsxfun(@rdivide, bsxfun(@minus, t, theta(:, 1)).^2, ...
+  2 .* theta(:, 2).^2)));
+return
@@ -55,6 +55,18 @@ function [sts, dcm] = pspm_dcm_inv(model, options)
 %   │                 [optional, numeric, default: 0.1, unit: second]
 %   │                 minimum dispersion (standard deviation) for flexible
 %   │                 responses.
+%   ├─────.parallel:  [optional, bool, default as 0]
+%   │                 invert the trial windows of all sessions on the workers
+%   │                 of a parallel pool, from speculative initial states and
+%   │                 priors that are refined in rounds (see Developer Notes).
+%   ├.speculative_tol:  [optional, numeric, default as 1e-3]
+%   │                 tolerance on the relative difference between speculative
+%   │                 and exact initial states and priors of a trial window.
+%   ├───.vb_backend:  [optional, 'vba' or 'pspm', default as 'vba']
+%   │                 Gauss-Newton update of the VB inversion. 'pspm' uses
+%   │                 pspm_dcm_iphi, which integrates the model and its
+%   │                 sensitivities in one call instead of one time step at a
+%   │                 time, with the same results.
 %   ├──────.dispwin:  [optional, bool, default as 1]
 %   │                 display progress window.
 %   └─.dispsmallwin:  [optional, bool, default as 0]
@@ -64,6 +76,13 @@ function [sts, dcm] = pspm_dcm_inv(model, options)
 %                     and aSCR amplitude are in SN units such that an
 %                     eSCR SN pulse with 1 unit amplitude causes an eSCR
 %                     with 1 mcS amplitude (unless model.norm = 1).
+%   ┌───────────dcm
+%   ├─.sn{sn}.diagnostics:
+%   │                 runs, converged, iterations, F and carry_error of the
+%   │                 VB inversion of each trial window.
+%   └──────.schedule: workers, rounds, inversions, time (s) and speedup,
+%                     i.e. the summed inversion time of the accepted trial
+%                     windows divided by the elapsed time.
 % ● Developer Notes
 %   There are two event types: flexible and fixed. The terminology is to call
 %   flexible responses aSCR (anticipatory) and fixed responses eSCR (evoked
@@ -74,6 +93,14 @@ function [sts, dcm] = pspm_dcm_inv(model, options)
 %   The SCR timeseries is z-transformed in pspm_dcm, and amplitude parameter
 %   estimates transformed back at the end (to standardise priors and
 %   precisions).
+%   Each trial window depends on the previous one through its initial
+%   states and the priors of the overlapping trials. With options.parallel,
+%   all trial windows are first inverted at once, starting from the data and
+%   the general priors, and each session is then replayed in trial order.
+%   Trial windows whose start differs from the preceding results by more
+%   than options.speculative_tol are inverted again in the next round,
+%   starting from these results. The first of them is then exact, such that
+%   the number of rounds is at most the number of trial windows per session.
 % ● References
 %   [1] Bach DR, Daunizeau J, Friston KJ, Dolan RJ (2010).
 %       Dynamic causal modelling of anticipatory skin conductance changes.
@@ -131,6 +158,9 @@ if options.invalid
 end
 try invopt.DisplayWin = options.dispwin; catch, invopt.DisplayWin = 1; end
 try invopt.GnFigs = options.dispsmallwin; catch, invopt.GnFigs = 0; end
+if strcmp(options.vb_backend, 'pspm')
+  invopt.Iphi_fname = @pspm_dcm_iphi;
+end
 sigma_offset_temp = settings.dcm{1}.sigma_offset;
 try settings.dcm{1}.sigma_offset = options.aSCR_sigma_offset; catch; end
 
@@ -460,11 +490,8 @@ u(5, :) = 0;
 u(6, :) = 0;
 u(:, 1) = 0;
 Theta = [theta, log(1)]';
-Xt = zeros(dim.n, size(u, 2));
 in = []; in.dt = 1/intsr;
-for k = 1:size(u, 2)
-  Xt(:, k + 1) = f_SCR(Xt(:, k), Theta, u(:, k), in);
-end
+[~, Xt] = pspm_dcm_integrate('f_SCR', zeros(dim.n, 1), Theta, u, in);
 eSCR_unit = 1/max(Xt(1, :));
 clear u Xt in Theta
 
@@ -477,351 +504,108 @@ u(5, :) = 1;
 u(6, :) = 5;
 u(7, :) = 10;
 Theta = [theta, 1 1]';
-Xt = zeros(7, size(u, 2));
 in = []; in.dt = 1/intsr;
-for k = 1:size(u, 2)
-  Xt(:, k + 1) = f_SCR(Xt(:, k), Theta, u(:, k), in);
-end
+[~, Xt] = pspm_dcm_integrate('f_SCR', zeros(7, 1), Theta, u, in);
 SCL_unit = 1/max(Xt(7, :));
 clear u Xt in Theta
 
 
 % (6) proceed session by session
 % =========================================================================
+% Each trial is inverted together with the following options.depth - 1
+% trials, starting from the hidden states and the priors estimated in the
+% previous trial window. With options.parallel, the trial windows of all
+% sessions are inverted on the workers of a parallel pool instead, see
+% speculative_inversion below.
 
 if ~options.getrf
+  % VB settings and session constants for the trial-wise inversions
+  V.f_fname = f_fname;
+  V.g_fname = g_fname;
+  V.dim = dim;
+  V.invopt = invopt;
+  V.settings = settings;
+  C = cell(numel(yscr), 1);
   for sn = 1:numel(yscr)
-    % initialise
-    Xt = zeros(dim.n, numel(yscr{sn}));
-    sfc = 0;
-    SCLtheta = [];
-    sfTheta  = [];
-    trlno = max([size(events{1}{sn}, 1), size(events{2}{sn}, 1)]);
-
-    trlstart = model.trlstart{sn};
-    trlstop  = model.trlstop{sn};
-    iti      = model.iti{sn};
-    miniti   = min(iti);                                                % minimum ITI
-
-    c = clock;
-    fprintf('----------------------------------------------------------\n');
-    fprintf('%02.0f:%02.0f:%02.0f: Session %1.0f - %1.0f Trials\n', c(4:6), sn, trlno);
-
-
-    % estimate trial-by-trial
-    % =======================================================================
-    if options.depth > trlno
-        trlindx = 1;
+    C{sn}.y = yscr{sn};
+    C{sn}.missing = model.missing_data{sn};
+    C{sn}.aevents = events{1}{sn};
+    C{sn}.eevents = events{2}{sn};
+    C{sn}.trlno = max([size(events{1}{sn}, 1), size(events{2}{sn}, 1)]);
+    C{sn}.trlstart = model.trlstart{sn};
+    C{sn}.trlstop = model.trlstop{sn};
+    C{sn}.iti = model.iti{sn};
+    C{sn}.miniti = min(C{sn}.iti);                                         % minimum ITI
+    if options.depth > C{sn}.trlno
+      C{sn}.trlindx = 1;
     else
-        trlindx = 1:trlno;
+      C{sn}.trlindx = 1:C{sn}.trlno;
     end
+    C{sn}.sr = sr;
+    C{sn}.options = options;
+    C{sn}.theta = theta;
+    C{sn}.theta_n = theta_n;
+    C{sn}.aSCRno = aSCRno;
+    C{sn}.eSCRno = eSCRno;
+    C{sn}.prior.aTheta = prior.aTheta;
+    C{sn}.prior.eTheta = prior.eTheta;
+    C{sn}.constrained = model.constrained;
+    C{sn}.constrained_upper = model.constrained_upper;
+    C{sn}.fixedSD = fixedSD;
+    C{sn}.sigma_offset = settings.dcm{1}.sigma_offset;
+    C{sn}.n = dim.n;
+    C{sn}.priors = priors;
+  end
 
-    for trl = trlindx
+  n_workers = 0;
+  if options.parallel
+    n_workers = parallel_workers;
+  end
+  schedule_start = tic;
+  if n_workers > 0
+    V.invopt.DisplayWin = 0;
+    V.invopt.GnFigs = 0;
+    [state, schedule] = speculative_inversion(C, V, n_workers, options.speculative_tol);
+  else
+    state = cell(numel(yscr), 1);
+    for sn = 1:numel(yscr)
       c = clock;
-      tic;
       fprintf('----------------------------------------------------------\n');
-      fprintf('%02.0f:%02.0f:%02.0f: Session %1.0f - Trial %1.0f\n', c(4:6), sn, trl);
-
-      % -- initialise
-      priors.muTheta = [];
-      priors.SigmaTheta = [];
-      u = [];
-
-      % -- timewindow: start of current trial until start of adepth trials
-      start = floor(sr * trlstart(trl));  % note there were rounding problems when using ceil here so use floor and exlude zeros
-      if start == 0, start = 1; end
-      if (trl + options.depth) <= trlno
-        adepth = options.depth;
-        stop = floor((sr * trlstart(trl + adepth)));
-        win = start:stop;
-      else
-        adepth = trlno - trl + 1;
-        % for last trial, if possible use at least 10 s of data, and at
-        % most min ITI. If this is not possible, use all available data.
-        stop = min([floor((sr * (trlstop(end) + min([miniti, 10])))), numel(yscr{sn})]);
-        win = start:stop;
-      end
-
-      % this leaves so many trials
-      trls = trl - 1 + (1:adepth);
-
-      % assign data
-      y = yscr{sn}(win);
-      ymissing = model.missing_data{sn}(win);
-
-      % intial states
-      priors.SigmaX0 = zeros(7);
-      priors.muX0 = zeros(7, 1);
-      if trl == 1
-        y_non_nan = y(~isnan(y));
-        priors.muX0(1) = mean(y_non_nan(1:3));%) - min(y);
-        priors.muX0(2) = mean(diff(y_non_nan(1:3)));
-        priors.muX0(3) = diff(diff(y_non_nan(1:3)));
-        priors.muX0(7) = 0;%min(y);
-        for n = [1:3 7]
-          priors.SigmaX0(n, n) = 1e-2;
-        end
-      else
-        priors.muX0 = Xt(:, win(1));
-      end
-
-      % -- prepare priors theta and input u
-      u(1, :) = (0:numel(y))/sr;
-      priors.muTheta = theta';
-
-      % -- define aSCR based on adepth (no of trials to be estimated) and
-      % -- asCRno (no of aSCR per trial)
-      % -- structure: trl 1 aSCR 1 - trl 1 aSCR 2 - trl 2 aSCR 1 - ...
-      % -- and for each aSCR: m - s - a
-
-      if aSCRno > 0
-        % get trial onsets and identify `dummy` events
-        aSCR_dummy = zeros(aSCRno, adepth);
-        aSCR_on = events{1}{sn}(trls, :, 1)';
-        aSCR_dummy(aSCR_on < 0) = 1;
-        % - get aSCR priors from previous estimations
-        aSCR_ind = theta_n  + (1:3:(3 * aSCRno * adepth));
-        if trl == 1
-          priors.muTheta(aSCR_ind)     = repmat(prior.aTheta.m, 1, adepth);
-          priors.muTheta(aSCR_ind + 1) = repmat(prior.aTheta.s, 1, adepth);
-          priors.muTheta(aSCR_ind + 2) = repmat(prior.aTheta.a, 1, adepth);
-        else
-          priors.muTheta(aSCR_ind)     = [[aTheta(trl + (0:(adepth - 2))).m], prior.aTheta.m];
-          priors.muTheta(aSCR_ind + 1) = [[aTheta(trl + (0:(adepth - 2))).s], prior.aTheta.s];
-          priors.muTheta(aSCR_ind + 2) = [[aTheta(trl + (0:(adepth - 2))).a], prior.aTheta.a];
-        end
-        % - define prior indices to be set to zero later on
-        aSCR_dummyind = aSCR_ind(aSCR_dummy == 1);
-        aSCR_dummyind = [aSCR_dummyind, aSCR_dummyind + 1, aSCR_dummyind + 2];
-        % - get aSCR number
-        u(2, :) = aSCRno * adepth;
-        % insert aSCR onsets (-10 s for dummy events)
-        aSCR_on(aSCR_dummy == 1) = -10;
-        u(5 + (1:u(2, 1)), :) = repmat(aSCR_on(:) - win(1)/sr, 1, size(u, 2));
-        % - get aSCR latency upper bound (0.1 for dummy events)
-        foo = diff(events{1}{sn}(trls, :, :), [], 3)';
-        foo(aSCR_dummy == 1) = 0.1;
-        u(5 + u(2, 1) + (1:u(2, 1)), :) = repmat(foo(:), 1, size(u, 2));
-        aSCR_ln(1:aSCRno, trl) = foo(:, 1); % save first trial for transformation of parameter values into seconds
-        % - get aSCR SD upper bound (zero for dummy events, fixed SD for constrained models)
-        if model.constrained
-            u(5 + 2 * u(2, 1) + (1:u(2, 1)), :) = repmat(fixedSD, numel(foo), size(u, 2)) - settings.dcm{1}.sigma_offset;
-        elseif model.constrained_upper > 0
-            u(5 + 2 * u(2, 1) + (1:u(2, 1)), :) = repmat(model.constrained_upper, numel(foo), size(u, 2)) - settings.dcm{1}.sigma_offset;
-        else
-            u(5 + 2 * u(2, 1) + (1:u(2, 1)), :) = repmat(foo(:)/2, 1, size(u, 2)) - settings.dcm{1}.sigma_offset;
-        end
-        % tidy up
-        clear aSCR_on foo aSCR_dummy
-      else
-        u(2, :) = 0; aSCR_dummyind = [];
-      end
-
-      % - get eSCR priors from previous estimations
-      if eSCRno > 0
-        % - identify `dummy` events
-        eSCR_dummy = zeros(eSCRno, adepth);
-        eSCR_on = events{2}{sn}(trls, :)';
-        eSCR_dummy(eSCR_on < 0) = 1;
-        % - get eSCR priors from previous estimations
-        eSCR_ind = theta_n + 3 * u(2, 1) + (1:(eSCRno * adepth));
-        if trl == 1
-          priors.muTheta(eSCR_ind) = repmat(prior.eTheta.a, 1, adepth);
-        else
-          priors.muTheta(eSCR_ind) = [[eTheta(trl + (0:(adepth - 2))).a], prior.eTheta.a];
-        end
-        % - define prior indices to be set to zero later on
-        eSCR_dummyind = eSCR_ind(eSCR_dummy == 1);
-        % - get eSCR number
-        u(3, :) = eSCRno * adepth;
-        % - insert eSCR onsets (-10 s for dummy events)
-        eSCR_on(eSCR_dummy == 1) = -10;
-        u(5 + 3 * u(2, 1) + (1:u(3, 1)), :) =  repmat((eSCR_on(:) - win(1)/sr), 1, size(u, 2));
-        % tidy up
-        clear eSCR_on eSCR_dummy
-      else
-        u(3, :) = 0; eSCR_dummyind = [];
-      end
-
-      % - insert SF if inter-trial intervals are long enough
-      sf = {}; lb = {}; ub = {};
-      for k = 1:adepth
-        if iti(trls(k)) > (options.sfpre + options.sfpost)
-          if trls(k) < trlno
-            lb{k, 1} = trlstop(trls(k)) + options.sfpost - win(1)/sr;
-            ub{k, 1} = trlstart(trls(k) + 1) - options.sfpre  - win(1)/sr;
-          else
-            lb{k, 1} = trlstop(trls(k)) + options.sfpost - win(1)/sr;
-            ub{k, 1} = win(end)/sr - win(1)/sr;
-          end
-          sf{k, 1} = (lb{k}:(1/options.sffreq):ub{k})' - lb{k, 1};
-          lb{k, 1} = repmat(lb{k, 1}, numel(sf{k, 1}), 1);
-          ub{k, 1} = repmat(ub{k, 1}, numel(sf{k, 1}), 1);
-        end
-      end
-      % -- number of responses to save
-      if isempty(sf)
-        sft = 0;
-      else
-        sft = numel(sf{1});
-      end
-      sf = cell2mat(sf);
-      lb = cell2mat(lb);
-      ub = cell2mat(ub);
-      % -- insert SF number and lower/upper bounds into u
-      if numel(sf) > 0
-        u(4, :) = numel(lb);
-        u(5 + 3 * u(2, 1) + u(3, 1) + (1:numel(sf)), :) = repmat(lb, 1, size(u, 2));
-        u(5 + 3 * u(2, 1) + u(3, 1) + numel(sf) + (1:numel(sf)), :) = repmat(ub, 1, size(u, 2));
-        % -- determine starting values from sigma function
-        sig.beta = 0.5; sig.G0 = 1;
-        val = -10:0.1:10;
-        sigma = sigm(val, sig);
-        start = theta_n + 3 * u(2, 1) + u(3, 1);
-        for n = 1:numel(sf)
-          [foo, ind] = min(abs(sigma - sf(n)/(ub(n) - lb(n))));
-          priors.muTheta(start + (n - 1) * 2 + 1)  = val(ind);
-        end
-        priors.muTheta(start + (2:2:(2 * numel(sf)))) = -3; % such that exp(a) < .1, which is the cutoff value for SF in Bach et al. (2010) Psychophysiology
+      fprintf('%02.0f:%02.0f:%02.0f: Session %1.0f - %1.0f Trials\n', c(4:6), sn, C{sn}.trlno);
+      % estimate trial-by-trial
+      state{sn} = initial_state(C{sn});
+      for trl = C{sn}.trlindx
+        c = clock;
+        fprintf('----------------------------------------------------------\n');
+        fprintf('%02.0f:%02.0f:%02.0f: Session %1.0f - Trial %1.0f\n', c(4:6), sn, trl);
+        res = invert_trial(trl, carry_for(trl, state{sn}, C{sn}), C{sn}, V);
+        state{sn} = apply_result(state{sn}, res);
+        state{sn}.diagnostics.runs(trl) = 1;
       end
-      clear int sf k start val sigma foo ind
-      % - add SCL changes if ITI is long enough
-      scllb = []; sclub = []; sclt = []; scla = [];
-      rmscltrl = zeros(size(trls));
-      c = 1;
-      for k = 1:numel(trls)
-        if iti(trls(k)) > (options.sclpre + options.sclpost)
-          if trls(k) < trlno
-            scllb(c) = trlstop(trls(k)) + options.sclpost - win(1)/sr;
-            sclub(c) = trlstart(trls(k) + 1) - options.sclpre  - win(1)/sr;
-          else
-            scllb(c) = trlstop(trls(k)) + options.sfpost - win(1)/sr;
-            sclub(c) = win(end)/sr;
-          end
-          try
-            sclt(c) = SCLtheta(trls(k)).t;
-            scla(c) = SCLtheta(trls(k)).a;
-          catch
-            sclt(c) = 0;
-            scla(c) = 0;
-          end
-          c = c + 1;
-        else
-          rmscltrl(k) = 1;
-        end
-      end
-      % if all trials are estimated at once, then retain this information
-      % for all trials; otherwise just extract the first trial.
-      if trlindx == 1
-          for k = 1:numel(trls)
-              if rmscltrl(k) == 1
-                  scl_lb(k) = -1; scl_ln(k) = -1;
-              else
-                  scl_lb(k) = scllb(k) + win(1)/sr; scl_ln(k) = sclub(k) - scllb(k);
-              end
-          end
-      else
-          if rmscltrl(1) == 1
-              scl_lb(trl) = -1; scl_ln(trl) = -1;
-          else
-              scl_lb(trl) = scllb(1) + win(1)/sr; scl_ln(trl) = sclub(1) - scllb(1);
-          end
-      end
-      % -- insert priors
-      u(5, :) = numel(scllb);
-      if u(5, 1) > 0
-        u(5 + 3 * u(2, 1) + u(3, 1) + 2 * u(4, 1) + (1:numel(scllb)), :) = repmat(scllb', 1, size(u, 2));
-        u(5 + 3 * u(2, 1) + u(3, 1) + 2 * u(4, 1) + numel(sclub) + (1:numel(sclub)), :) = repmat(sclub', 1, size(u, 2));
-        start = theta_n + 3 * u(2, 1) + u(3, 1) + 2 * u(4, 1);
-        priors.muTheta(start + (1:2:(2 * u(5, 1)))) = sclt; % prior timing, or zero
-        priors.muTheta(start + (2:2:(2 * u(5, 1)))) = scla; % amplitude: zero
-      end
-
-      % -- finalise prior structure
-      dim.n_theta = numel(priors.muTheta);
-      priors.SigmaTheta = 1e1 * eye(dim.n_theta);
-      % output function parameters are fixed
-      for n = 1:theta_n, priors.SigmaTheta(n, n) = 0; end
-      % allow more uncertainty for SF amplitude and less for SF timing
-      for n = (theta_n + 3 * u(2,1) + u(3,1) + 1):2:(theta_n + 3 * u(2,1) + u(3,1) + 2 * u(4, 1)), priors.SigmaTheta(n, n) = 1e-1; end
-      for n = (theta_n + 3 * u(2,1) + u(3,1) + 2):2:(theta_n + 3 * u(2,1) + u(3,1) + 2 * u(4, 1)), priors.SigmaTheta(n, n) = 1e-1; end
-      % allow less uncertainty for SCL changes
-      for n = (theta_n + 3 * u(2,1) + u(3,1) + 2 * u(4, 1) + 1):2:size(priors.SigmaTheta, 1), priors.SigmaTheta(n, n) = 1e-5; end
-      for n = (theta_n + 3 * u(2,1) + u(3,1) + 2 * u(4, 1) + 2):2:size(priors.SigmaTheta, 1), priors.SigmaTheta(n, n) = 1e-5; end
-      % allow no uncertainty for previous SCL change
-      if trl > 1
-        priors.SigmaTheta((end-1):end, (end-1):end) = zeros(2);
-      end
-      % allow no uncertainty for dummy events
-      for n = [aSCR_dummyind eSCR_dummyind], priors.SigmaTheta(n, n) = 0; end
-      % allow no uncertainty for aSCR dispersion of model is
-      % constrained
-      if model.constrained
-        aSCR_ind = theta_n  + (1:3:(3 * aSCRno * adepth)) + 1;
-        for n = aSCR_ind
-          priors.SigmaTheta(n, n) = 0;
-        end
-      end
-      % set u0
-      u(:, 1) = 0;
-      % initialise priors in correct dimensions
-      priors.iQy = cell(numel(y), 1);
-      priors.iQx = cell(numel(y), 1);
-      % default priors on noise covariance
-      for k = 1:numel(y)
-        priors.iQy{k} = 1;
-        priors.iQx{k} = eye(dim.n);
-      end
-      invopt.priors = priors;
-
-      % handle missing values
-      invopt.isYout = ymissing(:)';
-
-      % -- invert model
-      [post, out]= VBA_NLStateSpaceModel(y(:)',u,f_fname,g_fname,dim,invopt);
-
-      % -- extract aSCR and eSCR parameters from theta structure
-      for k = 1:adepth
-        m = trl + k - 1;
-        n = theta_n + 3 * aSCRno * (k - 1);
-        aTheta(m).m = post.muTheta(n + (1:3:(3*aSCRno)))';
-        aTheta(m).s = post.muTheta(n + (2:3:(3*aSCRno)))';
-        aTheta(m).a = post.muTheta(n + (3:3:(3*aSCRno)))';
-        n = theta_n + 3 * u(2, 2) + eSCRno * (k - 1);
-        eTheta(m).a = post.muTheta(n + (1:eSCRno))';
-      end
-
-      % -- extract SF parameters from theta structure (and transform timing
-      % right away)
-      if sft > 0
-        for sf = 1:sft
-          n = theta_n + 3 * u(2, 2) + u(3, 2) + 2 * (sf - 1) + 1;
-          sig.G0 = ub(sf) - lb(sf);
-          sfTheta(sf + sfc).t = win(1)/sr + lb(sf) + sigm(post.muTheta(n), sig);
-          sfTheta(sf + sfc).a = post.muTheta(n + 1);
-        end
-        sfc = sfc + sf;
-      end
-      % -- extract SCL parameters from theta structure (but don't
-      % transform timing)
-      for k = 1:u(5, 2)
-        n = theta_n + 3 * u(2, 2) + u(3, 2) + 2 * u(4, 2) + 2 * (k - 1) + 1;
-        SCLtheta(trls(k)).t = post.muTheta(n);
-        SCLtheta(trls(k)).a = post.muTheta(n + 1);
-      end
-      % -- extract hidden states
-      Xt(:, win) = post.muX;
-      % -- save results
-      posterior(trl) = post;
-      output(trl)    = out;
-      indata{trl}    = y(:)';
-      inwin{trl}     = win;
-      ut{trl}        = u;
-      mdl_time(trl)  = toc;
-      % - tidy up
-      clear sf sft post out trls start stop ub lb sig scllb sclub scla sclt
-
     end
+    schedule.workers = 0;
+    schedule.rounds = sum(cellfun(@(c) numel(c.trlindx), C));
+    schedule.inversions = schedule.rounds;
+  end
+  schedule.time = toc(schedule_start);
+  schedule.speedup = sum(cellfun(@(s) sum(s.mdl_time), state)) / schedule.time;
+
+  for sn = 1:numel(yscr)
+    aTheta = state{sn}.aTheta;
+    eTheta = state{sn}.eTheta;
+    sfTheta = state{sn}.sfTheta;
+    SCLtheta = state{sn}.SCLtheta;
+    Xt = state{sn}.Xt;
+    aSCR_ln = state{sn}.aSCR_ln;
+    scl_lb = state{sn}.scl_lb;
+    scl_ln = state{sn}.scl_ln;
+    posterior = state{sn}.posterior;
+    output = state{sn}.output;
+    ut = state{sn}.ut;
+    indata = state{sn}.indata;
+    inwin = state{sn}.inwin;
+    mdl_time = state{sn}.mdl_time;
+    trlindx = C{sn}.trlindx;
 
     % transform parameters
     % =======================================================================
@@ -907,9 +691,22 @@ if ~options.getrf
     dcm.sn{sn}.options = options;
     dcm.sn{sn}.model = model;
     dcm.sn{sn}.time = sum(mdl_time);
+    dcm.sn{sn}.diagnostics = state{sn}.diagnostics;
 
     clear aTheta eTheta sfTheta SCLtheta Xt yhat posterior output ut indata inwin
   end
+  dcm.schedule = schedule;
+  fprintf('----------------------------------------------------------\n');
+  fprintf('%1.0f inversions of %1.0f trial windows in %1.0f rounds on %1.0f workers: %.1f s, speedup %.2f.\n', ...
+    schedule.inversions, sum(cellfun(@(c) numel(c.trlindx), C)), schedule.rounds, ...
+    schedule.workers, schedule.time, schedule.speedup);
+  converged = cellfun(@(s) s.diagnostics.converged(~isnan(s.diagnostics.converged)), state, ...
+    'UniformOutput', false);
+  converged = [converged{:}];
+  if any(~converged)
+    fprintf('VB inversion did not converge in %1.0f of %1.0f trial windows.\n', ...
+      sum(~converged), numel(converged));
+  end
 else
   dcm.prior = prior;
 end
@@ -920,3 +717,503 @@ settings.dcm{1}.sigma_offset = sigma_offset_temp;
 dcm.invmodel = model;
 sts = 1;
 return
+
+function n_workers = parallel_workers
+% number of workers in the current parallel pool, which is started if
+% necessary; 0 if no pool is available
+n_workers = 0;
+try
+  pool = gcp;
+  if ~isempty(pool)
+    n_workers = pool.NumWorkers;
+  end
+catch
+  warning('ID:no_parallel_pool', 'Parallel pool not available, trials are inverted sequentially.');
+end
+return
+
+function [state, schedule] = speculative_inversion(C, V, n_workers, tol)
+% All trial windows are inverted in parallel. Trial windows other than the
+% first of each session start from speculative initial states and priors,
+% which in the first round are computed from the window data and the
+% general priors, and later from the results of the previous round. After
+% each round, every session is replayed in trial order, and trial windows
+% whose start differs from the one given by the preceding results by more
+% than tol are inverted again. The first trial window of each session that
+% is inverted again has an exact start, such that this terminates after at
+% most as many rounds as there are trial windows in a session; in the
+% worst case, this is the sequential inversion.
+sessions = cellfun(@(c) numel(c.trlindx), C);
+jobs = zeros(0, 2);
+for sn = 1:numel(C)
+  jobs = [jobs; repmat(sn, sessions(sn), 1), C{sn}.trlindx(:)]; %#ok<AGROW>
+end
+carry = cell(size(jobs, 1), 1);
+for j = 1:size(jobs, 1)
+  carry{j} = first_carry(jobs(j, 2), C{jobs(j, 1)});
+end
+result = cell(size(jobs, 1), 1);
+runs = zeros(size(jobs, 1), 1);
+err = zeros(size(jobs, 1), 1);
+pending = (1:size(jobs, 1))';
+rounds = 0;
+state = cell(numel(C), 1);
+while ~isempty(pending)
+  rounds = rounds + 1;
+  c = clock;
+  fprintf('----------------------------------------------------------\n');
+  fprintf('%02.0f:%02.0f:%02.0f: Round %1.0f - %1.0f trial windows\n', c(4:6), rounds, numel(pending));
+  job_list = jobs(pending, :);
+  job_carry = carry(pending);
+  job_result = cell(numel(pending), 1);
+  parfor (j = 1:numel(pending), n_workers)
+    job_result{j} = invert_trial(job_list(j, 2), job_carry{j}, C{job_list(j, 1)}, V);
+  end
+  result(pending) = job_result;
+  runs(pending) = runs(pending) + 1;
+  % replay sessions in trial order and check the start of each window
+  pending = zeros(0, 1);
+  j = 0;
+  for sn = 1:numel(C)
+    state{sn} = initial_state(C{sn});
+    for trl = C{sn}.trlindx
+      j = j + 1;
+      exact = carry_for(trl, state{sn}, C{sn});
+      err(j) = carry_error(carry{j}, exact);
+      if err(j) > tol
+        carry{j} = exact;
+        pending(end + 1, 1) = j; %#ok<AGROW>
+      end
+      state{sn} = apply_result(state{sn}, result{j});
+    end
+  end
+end
+j = 0;
+for sn = 1:numel(C)
+  for trl = C{sn}.trlindx
+    j = j + 1;
+    state{sn}.diagnostics.runs(trl) = runs(j);
+    state{sn}.diagnostics.carry_error(trl) = err(j);
+  end
+end
+schedule.workers = n_workers;
+schedule.rounds = rounds;
+schedule.inversions = sum(runs);
+return
+
+function state = initial_state(C)
+% results of a session before the first trial window
+trlno = C.trlno;
+state.Xt = zeros(C.n, numel(C.y));
+state.aTheta = struct('m', {}, 's', {}, 'a', {});
+state.eTheta = struct('a', {});
+state.sfTheta = [];
+state.SCLtheta = [];
+state.aSCR_ln = [];
+state.scl_lb = [];
+state.scl_ln = [];
+state.posterior = [];
+state.output = [];
+state.indata = {};
+state.inwin = {};
+state.ut = {};
+state.mdl_time = [];
+state.diagnostics.runs = zeros(1, trlno);
+state.diagnostics.converged = NaN(1, trlno);
+state.diagnostics.iterations = NaN(1, trlno);
+state.diagnostics.F = NaN(1, trlno);
+state.diagnostics.carry_error = zeros(1, trlno);
+return
+
+function [win, adepth, trls] = trial_window(trl, C)
+% timewindow: start of current trial until start of adepth trials
+start = floor(C.sr * C.trlstart(trl));  % note there were rounding problems when using ceil here so use floor and exlude zeros
+if start == 0, start = 1; end
+if (trl + C.options.depth) <= C.trlno
+  adepth = C.options.depth;
+  stop = floor((C.sr * C.trlstart(trl + adepth)));
+else
+  adepth = C.trlno - trl + 1;
+  % for last trial, if possible use at least 10 s of data, and at
+  % most min ITI. If this is not possible, use all available data.
+  stop = min([floor((C.sr * (C.trlstop(end) + min([C.miniti, 10])))), numel(C.y)]);
+end
+win = start:stop;
+% this leaves so many trials
+trls = trl - 1 + (1:adepth);
+return
+
+function carry = first_carry(trl, C)
+% initial states and priors of a trial window that do not depend on
+% previous trial windows; exact for the first trial of a session
+[win, adepth] = trial_window(trl, C);
+y = C.y(win);
+y_non_nan = y(~isnan(y));
+carry.muX0 = zeros(C.n, 1);
+if trl == 1 || numel(y_non_nan) >= 3
+  carry.muX0(1) = mean(y_non_nan(1:3));
+  carry.muX0(2) = mean(diff(y_non_nan(1:3)));
+  carry.muX0(3) = diff(diff(y_non_nan(1:3)));
+end
+carry.a_m = repmat(C.prior.aTheta.m, 1, adepth - 1);
+carry.a_s = repmat(C.prior.aTheta.s, 1, adepth - 1);
+carry.a_a = repmat(C.prior.aTheta.a, 1, adepth - 1);
+carry.e_a = repmat(C.prior.eTheta.a, 1, adepth - 1);
+carry.scl_t = zeros(1, adepth);
+carry.scl_a = zeros(1, adepth);
+return
+
+function carry = carry_for(trl, state, C)
+% initial states and priors of a trial window, given the results of the
+% previous trial windows
+if trl == 1
+  carry = first_carry(trl, C);
+  return
+end
+[win, adepth, trls] = trial_window(trl, C);
+previous = trl + (0:(adepth - 2));
+carry.muX0 = state.Xt(:, win(1));
+carry.a_m = [state.aTheta(previous).m];
+carry.a_s = [state.aTheta(previous).s];
+carry.a_a = [state.aTheta(previous).a];
+carry.e_a = [state.eTheta(previous).a];
+carry.scl_t = zeros(1, adepth);
+carry.scl_a = zeros(1, adepth);
+for k = 1:adepth
+  if trls(k) <= numel(state.SCLtheta) && ~isempty(state.SCLtheta(trls(k)).t)
+    carry.scl_t(k) = state.SCLtheta(trls(k)).t;
+    carry.scl_a(k) = state.SCLtheta(trls(k)).a;
+  end
+end
+return
+
+function err = carry_error(carry, exact)
+% maximum absolute difference, relative to the exact values if these are
+% larger than 1
+x = [carry.muX0(:); carry.a_m(:); carry.a_s(:); carry.a_a(:); carry.e_a(:); ...
+  carry.scl_t(:); carry.scl_a(:)];
+r = [exact.muX0(:); exact.a_m(:); exact.a_s(:); exact.a_a(:); exact.e_a(:); ...
+  exact.scl_t(:); exact.scl_a(:)];
+err = max(abs(x - r)) / max([1; abs(r)]);
+return
+
+function res = invert_trial(trl, carry, C, V)
+% invert one trial window, and extract its parameters; this is also run on
+% parallel workers, which do not share the global settings
+global settings
+settings = V.settings;
+t_start = tic;
+options = C.options;
+theta_n = C.theta_n;
+aSCRno = C.aSCRno;
+eSCRno = C.eSCRno;
+sr = C.sr;
+trlno = C.trlno;
+trlstart = C.trlstart;
+trlstop = C.trlstop;
+iti = C.iti;
+prior = C.prior;
+priors = C.priors;
+dim = V.dim;
+invopt = V.invopt;
+[win, adepth, trls] = trial_window(trl, C);
+
+% -- initialise
+priors.muTheta = [];
+priors.SigmaTheta = [];
+u = [];
+
+% assign data
+y = C.y(win);
+ymissing = C.missing(win);
+
+% intial states
+priors.SigmaX0 = zeros(7);
+priors.muX0 = carry.muX0;
+if trl == 1
+  for n = [1:3 7]
+    priors.SigmaX0(n, n) = 1e-2;
+  end
+end
+
+% -- prepare priors theta and input u
+u(1, :) = (0:numel(y))/sr;
+priors.muTheta = C.theta';
+
+% -- define aSCR based on adepth (no of trials to be estimated) and
+% -- asCRno (no of aSCR per trial)
+% -- structure: trl 1 aSCR 1 - trl 1 aSCR 2 - trl 2 aSCR 1 - ...
+% -- and for each aSCR: m - s - a
+
+res.aSCR_ln = zeros(aSCRno, 1);
+if aSCRno > 0
+  % get trial onsets and identify `dummy` events
+  aSCR_dummy = zeros(aSCRno, adepth);
+  aSCR_on = C.aevents(trls, :, 1)';
+  aSCR_dummy(aSCR_on < 0) = 1;
+  % - get aSCR priors from previous estimations
+  aSCR_ind = theta_n  + (1:3:(3 * aSCRno * adepth));
+  priors.muTheta(aSCR_ind)     = [carry.a_m, prior.aTheta.m];
+  priors.muTheta(aSCR_ind + 1) = [carry.a_s, prior.aTheta.s];
+  priors.muTheta(aSCR_ind + 2) = [carry.a_a, prior.aTheta.a];
+  % - define prior indices to be set to zero later on
+  aSCR_dummyind = aSCR_ind(aSCR_dummy == 1);
+  aSCR_dummyind = [aSCR_dummyind, aSCR_dummyind + 1, aSCR_dummyind + 2];
+  % - get aSCR number
+  u(2, :) = aSCRno * adepth;
+  % insert aSCR onsets (-10 s for dummy events)
+  aSCR_on(aSCR_dummy == 1) = -10;
+  u(5 + (1:u(2, 1)), :) = repmat(aSCR_on(:) - win(1)/sr, 1, size(u, 2));
+  % - get aSCR latency upper bound (0.1 for dummy events)
+  foo = diff(C.aevents(trls, :, :), [], 3)';
+  foo(aSCR_dummy == 1) = 0.1;
+  u(5 + u(2, 1) + (1:u(2, 1)), :) = repmat(foo(:), 1, size(u, 2));
+  res.aSCR_ln = foo(:, 1); % save first trial for transformation of parameter values into seconds
+  % - get aSCR SD upper bound (zero for dummy events, fixed SD for constrained models)
+  if C.constrained
+      u(5 + 2 * u(2, 1) + (1:u(2, 1)), :) = repmat(C.fixedSD, numel(foo), size(u, 2)) - C.sigma_offset;
+  elseif C.constrained_upper > 0
+      u(5 + 2 * u(2, 1) + (1:u(2, 1)), :) = repmat(C.constrained_upper, numel(foo), size(u, 2)) - C.sigma_offset;
+  else
+      u(5 + 2 * u(2, 1) + (1:u(2, 1)), :) = repmat(foo(:)/2, 1, size(u, 2)) - C.sigma_offset;
+  end
+  % tidy up
+  clear aSCR_on foo aSCR_dummy
+else
+  u(2, :) = 0; aSCR_dummyind = [];
+end
+
+% - get eSCR priors from previous estimations
+if eSCRno > 0
+  % - identify `dummy` events
+  eSCR_dummy = zeros(eSCRno, adepth);
+  eSCR_on = C.eevents(trls, :)';
+  eSCR_dummy(eSCR_on < 0) = 1;
+  % - get eSCR priors from previous estimations
+  eSCR_ind = theta_n + 3 * u(2, 1) + (1:(eSCRno * adepth));
+  priors.muTheta(eSCR_ind) = [carry.e_a, prior.eTheta.a];
+  % - define prior indices to be set to zero later on
+  eSCR_dummyind = eSCR_ind(eSCR_dummy == 1);
+  % - get eSCR number
+  u(3, :) = eSCRno * adepth;
+  % - insert eSCR onsets (-10 s for dummy events)
+  eSCR_on(eSCR_dummy == 1) = -10;
+  u(5 + 3 * u(2, 1) + (1:u(3, 1)), :) =  repmat((eSCR_on(:) - win(1)/sr), 1, size(u, 2));
+  % tidy up
+  clear eSCR_on eSCR_dummy
+else
+  u(3, :) = 0; eSCR_dummyind = [];
+end
+
+% - insert SF if inter-trial intervals are long enough
+sf = {}; lb = {}; ub = {};
+for k = 1:adepth
+  if iti(trls(k)) > (options.sfpre + options.sfpost)
+    if trls(k) < trlno
+      lb{k, 1} = trlstop(trls(k)) + options.sfpost - win(1)/sr;
+      ub{k, 1} = trlstart(trls(k) + 1) - options.sfpre  - win(1)/sr;
+    else
+      lb{k, 1} = trlstop(trls(k)) + options.sfpost - win(1)/sr;
+      ub{k, 1} = win(end)/sr - win(1)/sr;
+    end
+    sf{k, 1} = (lb{k}:(1/options.sffreq):ub{k})' - lb{k, 1};
+    lb{k, 1} = repmat(lb{k, 1}, numel(sf{k, 1}), 1);
+    ub{k, 1} = repmat(ub{k, 1}, numel(sf{k, 1}), 1);
+  end
+end
+% -- number of responses to save
+if isempty(sf)
+  sft = 0;
+else
+  sft = numel(sf{1});
+end
+sf = cell2mat(sf);
+lb = cell2mat(lb);
+ub = cell2mat(ub);
+% -- insert SF number and lower/upper bounds into u
+if numel(sf) > 0
+  u(4, :) = numel(lb);
+  u(5 + 3 * u(2, 1) + u(3, 1) + (1:numel(sf)), :) = repmat(lb, 1, size(u, 2));
+  u(5 + 3 * u(2, 1) + u(3, 1) + numel(sf) + (1:numel(sf)), :) = repmat(ub, 1, size(u, 2));
+  % -- determine starting values from sigma function
+  sig.beta = 0.5; sig.G0 = 1;
+  val = -10:0.1:10;
+  sigma = sigm(val, sig);
+  start = theta_n + 3 * u(2, 1) + u(3, 1);
+  for n = 1:numel(sf)
+    [foo, ind] = min(abs(sigma - sf(n)/(ub(n) - lb(n))));
+    priors.muTheta(start + (n - 1) * 2 + 1)  = val(ind);
+  end
+  priors.muTheta(start + (2:2:(2 * numel(sf)))) = -3; % such that exp(a) < .1, which is the cutoff value for SF in Bach et al. (2010) Psychophysiology
+end
+clear sf k start val sigma foo ind
+% - add SCL changes if ITI is long enough
+scllb = []; sclub = []; sclt = []; scla = [];
+rmscltrl = zeros(size(trls));
+c = 1;
+for k = 1:numel(trls)
+  if iti(trls(k)) > (options.sclpre + options.sclpost)
+    if trls(k) < trlno
+      scllb(c) = trlstop(trls(k)) + options.sclpost - win(1)/sr;
+      sclub(c) = trlstart(trls(k) + 1) - options.sclpre  - win(1)/sr;
+    else
+      scllb(c) = trlstop(trls(k)) + options.sfpost - win(1)/sr;
+      sclub(c) = win(end)/sr;
+    end
+    sclt(c) = carry.scl_t(k); % prior timing from previous trial window, or zero
+    scla(c) = carry.scl_a(k);
+    c = c + 1;
+  else
+    rmscltrl(k) = 1;
+  end
+end
+% if all trials are estimated at once, then retain this information
+% for all trials; otherwise just extract the first trial.
+res.scl_lb = [];
+res.scl_ln = [];
+if isequal(C.trlindx, 1)
+  res.scl_index = 1:numel(trls);
+  for k = 1:numel(trls)
+    if rmscltrl(k) == 1
+      res.scl_lb(k) = -1; res.scl_ln(k) = -1;
+    else
+      res.scl_lb(k) = scllb(k) + win(1)/sr; res.scl_ln(k) = sclub(k) - scllb(k);
+    end
+  end
+else
+  res.scl_index = trl;
+  if rmscltrl(1) == 1
+    res.scl_lb = -1; res.scl_ln = -1;
+  else
+    res.scl_lb = scllb(1) + win(1)/sr; res.scl_ln = sclub(1) - scllb(1);
+  end
+end
+% -- insert priors
+u(5, :) = numel(scllb);
+if u(5, 1) > 0
+  u(5 + 3 * u(2, 1) + u(3, 1) + 2 * u(4, 1) + (1:numel(scllb)), :) = repmat(scllb', 1, size(u, 2));
+  u(5 + 3 * u(2, 1) + u(3, 1) + 2 * u(4, 1) + numel(sclub) + (1:numel(sclub)), :) = repmat(sclub', 1, size(u, 2));
+  start = theta_n + 3 * u(2, 1) + u(3, 1) + 2 * u(4, 1);
+  priors.muTheta(start + (1:2:(2 * u(5, 1)))) = sclt; % prior timing, or zero
+  priors.muTheta(start + (2:2:(2 * u(5, 1)))) = scla; % amplitude: zero
+end
+
+% -- finalise prior structure
+dim.n_theta = numel(priors.muTheta);
+priors.SigmaTheta = 1e1 * eye(dim.n_theta);
+% output function parameters are fixed
+for n = 1:theta_n, priors.SigmaTheta(n, n) = 0; end
+% allow more uncertainty for SF amplitude and less for SF timing
+for n = (theta_n + 3 * u(2,1) + u(3,1) + 1):2:(theta_n + 3 * u(2,1) + u(3,1) + 2 * u(4, 1)), priors.SigmaTheta(n, n) = 1e-1; end
+for n = (theta_n + 3 * u(2,1) + u(3,1) + 2):2:(theta_n + 3 * u(2,1) + u(3,1) + 2 * u(4, 1)), priors.SigmaTheta(n, n) = 1e-1; end
+% allow less uncertainty for SCL changes
+for n = (theta_n + 3 * u(2,1) + u(3,1) + 2 * u(4, 1) + 1):2:size(priors.SigmaTheta, 1), priors.SigmaTheta(n, n) = 1e-5; end
+for n = (theta_n + 3 * u(2,1) + u(3,1) + 2 * u(4, 1) + 2):2:size(priors.SigmaTheta, 1), priors.SigmaTheta(n, n) = 1e-5; end
+% allow no uncertainty for previous SCL change
+if trl > 1
+  priors.SigmaTheta((end-1):end, (end-1):end) = zeros(2);
+end
+% allow no uncertainty for dummy events
+for n = [aSCR_dummyind eSCR_dummyind], priors.SigmaTheta(n, n) = 0; end
+% allow no uncertainty for aSCR dispersion of model is
+% constrained
+if C.constrained
+  aSCR_ind = theta_n  + (1:3:(3 * aSCRno * adepth)) + 1;
+  for n = aSCR_ind
+    priors.SigmaTheta(n, n) = 0;
+  end
+end
+% set u0
+u(:, 1) = 0;
+% initialise priors in correct dimensions
+priors.iQy = cell(numel(y), 1);
+priors.iQx = cell(numel(y), 1);
+% default priors on noise covariance
+for k = 1:numel(y)
+  priors.iQy{k} = 1;
+  priors.iQx{k} = eye(dim.n);
+end
+invopt.priors = priors;
+
+% handle missing values
+invopt.isYout = ymissing(:)';
+
+% -- invert model
+[post, out]= VBA_NLStateSpaceModel(y(:)',u,V.f_fname,V.g_fname,dim,invopt);
+
+% -- extract aSCR and eSCR parameters from theta structure
+res.a = struct('m', cell(1, adepth), 's', [], 'a', []);
+res.e = struct('a', cell(1, adepth));
+for k = 1:adepth
+  n = theta_n + 3 * aSCRno * (k - 1);
+  res.a(k).m = post.muTheta(n + (1:3:(3*aSCRno)))';
+  res.a(k).s = post.muTheta(n + (2:3:(3*aSCRno)))';
+  res.a(k).a = post.muTheta(n + (3:3:(3*aSCRno)))';
+  n = theta_n + 3 * u(2, 2) + eSCRno * (k - 1);
+  res.e(k).a = post.muTheta(n + (1:eSCRno))';
+end
+
+% -- extract SF parameters from theta structure (and transform timing
+% right away)
+res.sf = struct('t', {}, 'a', {});
+sig.beta = 0.5;
+for k = 1:sft
+  n = theta_n + 3 * u(2, 2) + u(3, 2) + 2 * (k - 1) + 1;
+  sig.G0 = ub(k) - lb(k);
+  res.sf(k).t = win(1)/sr + lb(k) + sigm(post.muTheta(n), sig);
+  res.sf(k).a = post.muTheta(n + 1);
+end
+% -- extract SCL parameters from theta structure (but don't
+% transform timing)
+res.scl_trials = trls(1:u(5, 2));
+res.scl = struct('t', cell(1, u(5, 2)), 'a', []);
+for k = 1:u(5, 2)
+  n = theta_n + 3 * u(2, 2) + u(3, 2) + 2 * u(4, 2) + 2 * (k - 1) + 1;
+  res.scl(k).t = post.muTheta(n);
+  res.scl(k).a = post.muTheta(n + 1);
+end
+% -- extract hidden states and save results
+res.trl = trl;
+res.trls = trls;
+res.win = win;
+res.Xwin = post.muX;
+res.post = post;
+res.out = out;
+res.y = y(:)';
+res.u = u;
+if isfield(out, 'CV')
+  res.converged = double(out.CV);
+else
+  res.converged = NaN;
+end
+res.iterations = out.it;
+res.F = out.F;
+res.time = toc(t_start);
+return
+
+function state = apply_result(state, res)
+% add the results of one trial window to the results of a session
+trl = res.trl;
+state.aTheta(res.trls) = res.a;
+state.eTheta(res.trls) = res.e;
+if ~isempty(res.sf)
+  state.sfTheta = [state.sfTheta, res.sf];
+end
+for k = 1:numel(res.scl)
+  state.SCLtheta(res.scl_trials(k)).t = res.scl(k).t;
+  state.SCLtheta(res.scl_trials(k)).a = res.scl(k).a;
+end
+state.aSCR_ln(1:numel(res.aSCR_ln), trl) = res.aSCR_ln;
+state.scl_lb(res.scl_index) = res.scl_lb;
+state.scl_ln(res.scl_index) = res.scl_ln;
+state.Xt(:, res.win) = res.Xwin;
+state.posterior(trl) = res.post;
+state.output(trl) = res.out;
+state.indata{trl} = res.y;
+state.inwin{trl} = res.win;
+state.ut{trl} = res.u;
+state.mdl_time(trl) = res.time;
+state.diagnostics.converged(trl) = res.converged;
+state.diagnostics.iterations(trl) = res.iterations;
+state.diagnostics.F(trl) = res.F;
+return
@@ -0,0 +1,197 @@
+function [Iphi, SigmaPhi, deltaMuPhi, suffStat] = pspm_dcm_iphi(phi, y, posterior, suffStat, dim, u, options)
+% ● Description
+%   pspm_dcm_iphi is an alternative backend for the Gauss-Newton update in
+%   VBA_NLStateSpaceModel, for the deterministic SCR model (f_SCR and g_SCR)
+%   inverted by pspm_dcm_inv, and the deterministic SF model (f_SF and
+%   g_Id) inverted by pspm_sf_dcm. It computes the same variational energy,
+%   posterior covariance, update step and sufficient statistics as
+%   VBA_Iphi, and is used instead of VBA_Iphi when the VBA option
+%   .Iphi_fname is set to @pspm_dcm_iphi (see options.vb_backend in
+%   pspm_dcm_inv and pspm_sf_dcm). Models that it does not support are
+%   passed on to VBA_Iphi.
+% ● Format
+%   [Iphi, SigmaPhi, deltaMuPhi, suffStat] = ...
+%     pspm_dcm_iphi(phi, y, posterior, suffStat, dim, u, options)
+% ● Arguments
+%   *          phi : [vector] parameters to be updated, i.e. evolution
+%                    parameters and initial states with non-zero prior
+%                    variance.
+%   *            y : [row vector] data.
+%   *    posterior : [struct] current VBA posterior.
+%   *     suffStat : [struct] current VBA sufficient statistics.
+%   *          dim : [struct] VBA dimensions of the deterministic model.
+%   *            u : [matrix] input, one column per time step.
+%   *      options : [struct] VBA options of the deterministic model, as
+%                    set up by VBA_check.
+% ● Output
+%   *         Iphi : variational energy.
+%   *     SigmaPhi : posterior covariance of phi.
+%   *   deltaMuPhi : Gauss-Newton step.
+%   *     suffStat : updated sufficient statistics.
+% ● Developer's notes
+%   VBA inverts deterministic models through VBA_odeLim, which evaluates
+%   the evolution and observation functions and the sensitivities of the
+%   states to the parameters one time step at a time, for every
+%   Gauss-Newton iteration. Here, the trajectory and the Jacobians are
+%   computed in one call to pspm_dcm_integrate. The sensitivities to the evolution parameters and
+%   initial states follow a linear recursion with the constant state
+%   Jacobian, and are integrated in one loop together with the predicted
+%   state covariance. The posterior precision matrix is inverted, and the
+%   Gauss-Newton step solved, with its Cholesky factor, after the same
+%   regularisation as in VBA_inv.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Check model
+[supported, f_fname, dgdx] = is_supported(y, options);
+if ~supported
+  [Iphi, SigmaPhi, deltaMuPhi, suffStat] = VBA_Iphi(phi, y, posterior, suffStat, dim, u, options);
+  return
+end
+if options.DisplayWin
+  set(options.display.hm(1), 'string', 'VB Gauss-Newton on observation/evolution parameters... ');
+  set(options.display.hm(2), 'string', '0%');
+  drawnow
+end
+old = options.inG.old;
+n = old.dim.n;
+n_theta = old.dim.n_theta;
+n_phi = old.dim.n_phi;
+n_t = dim.n_t;
+indIn = options.params2update.phi;
+sigmaHat = posterior.a_sigma ./ posterior.b_sigma;
+iQy = [options.priors.iQy{:, 1}];
+Q = options.priors.SigmaPhi(indIn, indIn);
+iQ = VBA_inv(Q, []);
+muPhi0 = options.priors.muPhi;
+Phi = muPhi0;
+Phi(indIn) = phi;
+dphi0 = muPhi0 - Phi;
+% Phi holds the observation parameters, evolution parameters and initial
+% states of the original model, in this order
+if old.options.updateX0
+  X0 = Phi(n_phi + n_theta + (1:n));
+else
+  X0 = old.options.priors.muX0;
+end
+
+%% Trajectory and sensitivities
+[~, Xt, dfdx, dfdP] = pspm_dcm_integrate(f_fname, X0, Phi(n_phi + (1:n_theta)), ...
+  u(:, 1:n_t), old.options.inF);
+muX = Xt(:, 2:end);
+gx = dgdx' * muX;
+% dx holds the derivatives of the states at time t with respect to Phi, as
+% out.dx of VBA_odeLim; the observation functions do not depend on their
+% parameters
+dxdTheta = zeros(n_theta, n);
+dxdx0 = eye(n);
+dG_dPhi = zeros(dim.n_phi, n_t);
+SigmaX = cell(n_t, 1);
+for t = 1:n_t
+  dxdTheta = dfdP(:, :, t) + dxdTheta * dfdx;
+  if old.options.updateX0
+    dxdx0 = dxdx0 * dfdx;
+    dx = [zeros(n_phi, n); dxdTheta; dxdx0];
+  else
+    dx = [zeros(n_phi, n); dxdTheta];
+  end
+  dG_dPhi(:, t) = dx * dgdx;
+  SigmaX{t} = dx' * posterior.SigmaPhi * dx;
+end
+div = isweird({gx, dG_dPhi});
+
+%% Sufficient statistics
+dy = y - gx;
+dy2 = sum(iQy .* dy.^2);
+ddydphi = dG_dPhi * (iQy .* dy)';
+d2gdx2 = bsxfun(@times, dG_dPhi, iQy) * dG_dPhi';
+% residual variance is zero for excluded data, as in VBA_inv
+iQy_inv = zeros(size(iQy));
+iQy_inv(iQy ~= 0) = 1 ./ iQy(iQy ~= 0);
+vy = sum(dG_dPhi .* (posterior.SigmaPhi * dG_dPhi), 1) + (1 ./ sigmaHat) .* iQy_inv;
+if options.DisplayWin
+  set(options.display.hm(2), 'string', 'OK');
+  drawnow
+end
+
+%% Gauss-Newton update
+iSigmaPhi = iQ + sigmaHat .* d2gdx2(indIn, indIn);
+tmp = iQ * dphi0(indIn) + sigmaHat .* ddydphi(indIn);
+k = numel(indIn);
+tol = max(eps(norm(iSigmaPhi, 'inf')) * k, exp(-32));
+[R, p] = chol(iSigmaPhi + eye(k) * tol);
+if p == 0
+  iR = R \ eye(k);
+  SigmaPhi = iR * iR';
+  deltaMuPhi = R \ (R' \ tmp);
+else
+  SigmaPhi = VBA_inv(iSigmaPhi, []);
+  deltaMuPhi = SigmaPhi * tmp;
+end
+Iphi = -0.5 .* dphi0(indIn)' * iQ * dphi0(indIn) - 0.5 * sigmaHat .* dy2;
+if isweird({Iphi, SigmaPhi}) || div
+  Iphi = -Inf;
+end
+
+suffStat.Iphi = Iphi;
+suffStat.gx = gx;
+suffStat.dy = dy;
+suffStat.dy2 = dy2;
+suffStat.vy = vy;
+suffStat.dphi = dphi0;
+suffStat.muX = muX;
+suffStat.SigmaX = SigmaX;
+suffStat.div = div;
+return
+
+function [supported, f_fname, dgdx] = is_supported(y, options)
+% deterministic f_SCR and g_SCR, or f_SF and g_Id model with a single
+% Gaussian data source, and without micro-time resolution, delays or
+% skipped evolution steps; dgdx is the constant observation gradient
+supported = false;
+f_fname = '';
+dgdx = [];
+if ~isequal(options.g_fname, @VBA_odeLim) || size(y, 1) ~= 1 || options.extended || ...
+    options.binomial || options.nmog > 1 || options.UNL
+  return
+end
+old = options.inG.old;
+if old.options.decim ~= 1 || any(old.options.skipf) || any(old.options.delays(:))
+  return
+end
+f_fname = fname_string(old.options.f_fname);
+g_fname = fname_string(old.options.g_fname);
+if strcmp(f_fname, 'f_SCR') && strcmp(g_fname, 'g_SCR') && old.dim.n == 7 && ...
+    old.dim.n_phi == 0
+  % g_SCR sums states 1, 4 and 7
+  dgdx = zeros(7, 1);
+  dgdx([1, 4, 7]) = 1;
+elseif strcmp(f_fname, 'f_SF') && strcmp(g_fname, 'g_Id') && old.dim.n == 3
+  % g_Id observes one state, possibly scaled
+  inG = old.options.inG;
+  ind = 1;
+  scale = 1;
+  if isfield(inG, 'ind')
+    ind = inG.ind;
+  end
+  if isfield(inG, 'scale')
+    scale = inG.scale;
+  end
+  if ~isscalar(ind) || ~isscalar(scale) || (isfield(inG, 'k') && inG.k ~= 1)
+    return
+  end
+  dgdx = zeros(3, 1);
+  dgdx(ind) = scale;
+else
+  return
+end
+supported = true;
+return
+
+function name = fname_string(fname)
+if isa(fname, 'function_handle')
+  name = func2str(fname);
+else
+  name = fname;
+end
+return
@@ -7,12 +7,27 @@ function [sts, data, newsr] = pspm_downsample(data, sr,sr_down)
 %           [sts, data, newsr] = pspm_downsample(data, sr,sr_down)
 %
 % ● Arguments
-%   *        data:    the input data for performing downsampling on.
+%   *        data:    the input data for performing downsampling on. A
+%                     vector, or a matrix with one channel per column.
 %   *        sr:      original sampling rate of the input data.
 %   *        sr_down: targeted downsampling rate.
 %
 % ● Output
-%   *       sts: -1 if the frequency ratio is not an integer
+%   *       sts: -1 if the input is invalid
+%   *      data: downsampled data
+%   *     newsr: new sampling rate; equal to sr_down unless the ratio of
+%                sampling rates has no rational approximation with
+%                numerator and denominator up to 2^16
+% ● Developer's notes
+%   Integer ratios are downsampled by taking every n-th sample, as the data
+%   are low pass filtered by the callers. Other ratios are approximated by
+%   a fraction p/q and resampled with a polyphase FIR filter: a Kaiser
+%   windowed sinc (10 zero crossings on each side, beta = 5) with cut-off at
+%   the lower of both Nyquist frequencies, as in the Signal Processing
+%   Toolbox function resample. The filter is split into p phases that are
+%   normalised to unit DC gain and kept in a cache for the session. Data
+%   are extended with their first and last values instead of zeros, which
+%   avoids a drop at the edges.
 % ● History
 %   Introduced in PsPM 3.0
 %   Written in 2008-2015 by Dominik R Bach (Wellcome Trust Centre for Neuroimaging)
@@ -32,35 +47,90 @@ if nargin < 2
 end
 
 %% 3 Performing downsampling
-
+is_row = isrow(data);
+if is_row
+  data = data(:);
+end
 freqratio = sr/sr_down;
 
 if freqratio == ceil(freqratio) % NB isinteger might not work for some values
-    % this gives the same output as the signal processing toolbox function
-    % downsample(data, freqratio)
-    data = data(1:freqratio:end); % from old pspm_downsample
-    newsr = sr_down;
-    sts = 1;
-elseif settings.signal
-    % this uses a filter and is therefore not used for integer sampling
-    % ratio. It allows real sr ratios but requires integer initial and final sr
-    if sr == floor(sr) && sr_down == floor(sr_down)
-        data = resample(data, sr_down, sr);
-        newsr = sr_down;
-    else
-        % use a crude but very general way of getting to integer numbers by
-        % changing the new sampling rate
-        altsr = round(sr);
-        altdownsr = round(sr_down);
-        data = resample(data, altdownsr, altsr);
-        newsr = sr * altdownsr/altsr;
-        warning('ID:freq_change', 'The desired downsample rate was changed.');
-    end
-    sts = 1;
+  % this gives the same output as the signal processing toolbox function
+  % downsample(data, freqratio)
+  data = data(1:freqratio:end, :); % from old pspm_downsample
+  newsr = sr_down;
 else
-    sts = -1;
-    warning('ID:nonint_sr', 'Downsampling failed because signal processing toolbox is not installed and downsampling ratio is non-integer.');
-    % the function returns the original data
+  % rational approximation of the ratio, as exact as possible with
+  % numerator and denominator up to 2^16
+  for tol = [1e-12, 1e-9, 1e-6, 1e-3]
+    [p, q] = rat(sr_down / sr, tol * sr_down / sr);
+    if max(p, q) <= 2^16
+      break
+    end
+  end
+  newsr = sr * p / q;
+  if abs(newsr - sr_down) > 1e-9 * sr_down
+    warning('ID:freq_change', 'The desired downsample rate was changed to %0.6f Hz.', newsr);
+  else
+    newsr = sr_down;
+  end
+  data = resample_poly(double(data), p, q);
 end
+if is_row
+  data = data.';
+end
+sts = 1;
+return
 
+function y = resample_poly(x, p, q)
+persistent banks
+if isempty(banks)
+  banks = containers.Map('KeyType', 'char', 'ValueType', 'any');
+end
+key = sprintf('%d/%d', p, q);
+if isKey(banks, key)
+  bank = banks(key);
+else
+  bank = filter_bank(p, q);
+  if banks.Count >= 20
+    banks = containers.Map('KeyType', 'char', 'ValueType', 'any');
+  end
+  banks(key) = bank;
+end
+n = size(x, 1);
+M = ceil(n * p / q);
+y = zeros(M, size(x, 2));
+% output m (zero-based) lies at m * q in the upsampled signal; it uses the
+% filter phase mod(m * q, p) and the input samples from kmin onwards
+chunk = max(1, floor(2^20 / bank.K));
+for m0 = 0:chunk:(M - 1)
+  m = (m0:min(M - 1, m0 + chunk - 1))';
+  a = m * q;
+  phase = mod(a, p) + 1;
+  kmin = (a - bank.R + mod(bank.R - a, p)) / p;
+  for j = 1:bank.K
+    k = min(max(kmin + j, 1), n);
+    y(m + 1, :) = y(m + 1, :) + bsxfun(@times, bank.W(phase, j), x(k, :));
+  end
+end
 
+function bank = filter_bank(p, q)
+% polyphase decomposition of a Kaiser windowed sinc low pass filter
+N = 10;
+beta = 5;
+pq = max(p, q);
+R = N * pq;
+fc = 1 / (2 * pq);
+t = -R:R;
+h = 2 * fc * ones(size(t));
+nz = t ~= 0;
+h(nz) = sin(2 * pi * fc * t(nz)) ./ (pi * t(nz));
+h = h .* besseli(0, beta * sqrt(1 - (t / R).^2)) / besseli(0, beta);
+K = floor(2 * R / p) + 1;
+W = zeros(p, K);
+for r = 0:(p - 1)
+  tt = R - mod(R - r, p) - (0:(K - 1)) * p;
+  valid = abs(tt) <= R;
+  W(r + 1, valid) = h(tt(valid) + R + 1);
+end
+W = bsxfun(@rdivide, W, sum(W, 2));
+bank = struct('W', W, 'K', K, 'R', R);
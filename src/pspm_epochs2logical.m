@@ -14,6 +14,8 @@ function index = pspm_epochs2logical(epochs, datalength, sr)
 %                    if epochs are specified in terms of data samples: 1
 % ● Output
 %   *        index : [logical] index
+% ● Developer's notes
+%   The index is built by pspm_intervals in one pass over the data.
 % ● History
 %   Introduced in PsPM 6.1.2
 %   Written in 2024 by Dominik Bach (Uni Bonn)
@@ -26,12 +28,6 @@ if nargin > 2 && sr ~= 1
     epochs = pspm_time2index(epochs, sr);
 end
 
-index = zeros(datalength, 1);
-if ~isempty(epochs)
-    for k = 1:size(epochs, 1)
-        flanks = epochs(k,:);
-        % ensure the epoch has duration: diff(flanks)
-        index(flanks(1):(flanks(2) - 1)) = 1;
-    end
-end
-index = index(1:datalength);
+% each epoch covers samples onset:(offset - 1), such that it has duration
+% diff(flanks)
+index = double(pspm_intervals('to_logical', epochs, datalength));
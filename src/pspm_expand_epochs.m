@@ -14,7 +14,9 @@ function [sts, out] = pspm_expand_epochs(varargin)
 %   *      epochs:  A 2-column matrix with epochs onsets and offsets in seconds.
 %   *     data_fn:  A PsPM data file.
 %   *     channel:  Channel identifier accepted by pspm_load_channel.
-%   *   expansion:  A 2-element vector with positive numbers [pre, post]
+%   *   expansion:  A 2-element vector with positive numbers [pre, post].
+%                   Overlapping expanded epochs are merged, and negative
+%                   onsets and offsets are set to 0.
 %   ┌────────────options:
 %   ├─────────.overwrite: Define if already existing files should be
 %   │                     overwritten. Default ist 2. (Only used if input
@@ -136,14 +138,9 @@ if isempty(epochs)
     warning('No epochs found.');
     expanded_epochs = [];
 else
-    pre = expansion(1);
-    post = expansion(2);
-    expanded_epochs_temp = [epochs(:,1) - pre, epochs(:,2) + post];
-    % remove negative values and merge overlapping epochs
-    [ksts, expanded_epochs] = pspm_get_timing('missing', expanded_epochs_temp, 'seconds') ;
-    if ksts < 1 
-        return
-    end
+    % expand and merge overlapping epochs, and set negative values to 0;
+    % epochs are not removed, such that an epoch ending at 0 is kept as [0, 0]
+    expanded_epochs = max(pspm_intervals('expand', epochs, expansion), 0);
 end
 
 % generate output
@@ -245,7 +245,7 @@ missing = cellfun(@(x, y) pspm_epochs2logical(x, y, sr), missing(:), num2cell(se
 
 %% extract segments
 for i_cond = 1:numel(onsets)
-    [sts, segments{i_cond}.data, segments{i_cond}.sessions] = pspm_extract_segments_core(data_raw, onsets{i_cond}, pspm_time2index(options.length, sr, inf, 1), missing);
+    [sts, segments{i_cond}.data, segments{i_cond}.sessions, stats{i_cond}] = pspm_extract_segments_core(data_raw, onsets{i_cond}, pspm_time2index(options.length, sr, inf, 1), missing);
     if sts < 1, return; end
 end
 
@@ -267,9 +267,9 @@ for c=1:numel(onsets)
   m = segments{c}.data;
   segments{c}.name = names{c};
   % create mean
-  segments{c}.mean = nanmean(m, 1);
-  segments{c}.std = nanstd(m, [], 1);
-  segments{c}.sem = segments{c}.std./sqrt(size(segments{c}.data, 1));
+  segments{c}.mean = stats{c}.mean;
+  segments{c}.std = stats{c}.std;
+  segments{c}.sem = stats{c}.sem;
   segments{c}.trial_nan_percent = 100.0 * sum(isnan(m), 2)/size(m,2);
   segments{c}.total_nan_percent = 100.0 * sum(sum(isnan(m), 2))/numel(m);
   %   segments{c}.total_nan_percent = mean(segments{c}.trial_nan_percent);
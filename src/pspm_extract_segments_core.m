@@ -1,9 +1,10 @@
-function [sts, segments, sessions] = pspm_extract_segments_core(data, onsets, segment_length, missing)
+function [sts, segments, sessions, stats] = pspm_extract_segments_core(data, onsets, segment_length, missing)
 % ● Description
 %   pspm_extract_segments_core extracts segments of equal length from a
 %   cell array of data
 % ● Format
 %   [sts, segments, session_index] = pspm_extract_segments_core(data, onsets, segment_length, missing)
+%   [sts, segments, session_index, stats] = pspm_extract_segments_core(data, onsets, segment_length, missing)
 % ● Arguments
 %   *      data : [cell] a cell array of data vectors of arbitrary length
 %   *    onsets : [cell] a cell array of the same size as 'data', with segment onsets
@@ -13,6 +14,19 @@ function [sts, segments, sessions] = pspm_extract_segments_core(data, onsets, se
 %   *   missing : [cell array] OPTIONAL a logical index of missing values which will be
 %                 set to NaN in the extracted segments. A cell array of the same size
 %                 as 'data', with elements of the same size as the elements of 'data'.
+% ● Output
+%   *  segments : [matrix] trials x segment_length, segments that extend
+%                 beyond the end of a session are padded with NaN
+%   *  sessions : [vector] session index of each trial
+%   ┌─────stats : [struct] OPTIONAL statistics over trials, ignoring NaN
+%   ├─────.mean : mean of each sample across trials
+%   ├──────.std : standard deviation of each sample across trials
+%   └──────.sem : standard error of the mean (std divided by the square root
+%                 of the number of trials)
+% ● Developer's notes
+%   The number of trials is known from the onsets, so the output is
+%   allocated once and all segments of one session are copied with one
+%   indexing operation.
 % ● History
 %   Introduced in PsPM version 6.2
 
@@ -21,6 +35,7 @@ sts = -1;
 
 segments = []; % Initialize segments matrix
 sessions = []; % Initialize session index vector
+stats = struct();
 
 % check input -------------------------------------------------------------
 if nargin < 4
@@ -36,11 +51,17 @@ if ~(length(data) == length(onsets) && length(data) == length(missing))
     return;
 end
 
+% Allocate output ---------------------------------------------------------
+n_trials = cellfun(@numel, onsets(:));
+segments = NaN(sum(n_trials), segment_length);
+sessions = zeros(sum(n_trials), 1);
+trial_offset = [0; cumsum(n_trials)];
+
 % Iterate through each cell of data ---------------------------------------
 for i = 1:length(data)
-    currentData = data{i}(:)';
-    currentOnsets = int64(onsets{i});
-    currentMissing = missing{i}(:)';
+    currentData = data{i}(:);
+    currentOnsets = double(int64(onsets{i}(:)));
+    currentMissing = logical(missing{i}(:));
 
     % Check for valid onsets
     if any(currentOnsets < 1) || any(currentOnsets > length(currentData))
@@ -59,22 +80,25 @@ for i = 1:length(data)
         currentData(currentMissing) = NaN;
     end
 
-    % Extract segments
-    for j = 1:length(currentOnsets)
-        onset = currentOnsets(j);
-        endIndex = onset + segment_length - 1;
-
-        % Check if the segment extends beyond the data.
-        if endIndex > length(currentData)
-            segment = [currentData(onset:end), NaN(1, endIndex - length(currentData))];
-        else
-            segment = currentData(onset:endIndex);
-        end
+    % Extract segments; samples beyond the data stay NaN
+    rows = (trial_offset(i) + 1):trial_offset(i + 1);
+    idx = bsxfun(@plus, currentOnsets, 0:(segment_length - 1));
+    inside = idx <= length(currentData);
+    segment = NaN(numel(currentOnsets), segment_length);
+    segment(inside) = currentData(idx(inside));
+    segments(rows, :) = segment;
+    sessions(rows) = i;
+end
+if sum(n_trials) == 0
+    segments = [];
+    sessions = [];
+end
 
-        % Add to segments and sessions
-        segments = [segments; segment];
-        sessions = [sessions; i];
-    end
+% Statistics --------------------------------------------------------------
+if nargout > 3
+    stats.mean = mean(segments, 1, 'omitnan');
+    stats.std = std(segments, 0, 1, 'omitnan');
+    stats.sem = stats.std ./ sqrt(size(segments, 1));
 end
 sts = 1;
 end
@@ -0,0 +1,114 @@
+function [sts, plan] = pspm_filter_plan(filt)
+% ● Description
+%   pspm_filter_plan returns the Butterworth filters needed by pspm_prepdata
+%   for one filter specification, in second-order section form and with
+%   their steady-state initial conditions. Plans are designed once and then
+%   served from a cache for the rest of the MATLAB session, so that
+%   repeated calls with the same specification (e.g. when pspm_glm filters
+%   every regressor column) do not redesign the filters.
+% ● Format
+%   [sts, plan] = pspm_filter_plan(filt)
+%   pspm_filter_plan('clear')
+% ● Arguments
+%   ┌──────filt
+%   ├───────.sr:  current sample rate in Hz
+%   ├───.lpfreq:  low pass filter frequency, or 'none'/NaN
+%   ├──.lporder:  low pass filter order
+%   ├───.hpfreq:  high pass filter frequency, or 'none'/NaN
+%   ├──.hporder:  high pass filter order
+%   └.direction:  filter direction, 'uni' or 'bi'
+% ● Output
+%   *       sts:  1 if the plan could be created, -1 otherwise
+%   ┌──────plan
+%   ├──────.key:  cache key of this plan
+%   ├───────.lp:  empty if no low pass filter is applied (cut-off frequency
+%   │             not given, or not below the Nyquist frequency), otherwise
+%   │             a struct with the fields b and a (second-order sections
+%   │             and gain for pspm_filtfilt; a single section is given as
+%   │             transfer function) and zi (initial conditions, only for
+%   │             bidirectional filtering)
+%   └───────.hp:  the same for the high pass filter
+% ● Developer's notes
+%   The cache is a persistent map keyed by sample rate, cut-off frequencies,
+%   orders and direction, and is emptied when it exceeds 100 plans or when
+%   called with 'clear'. Each MATLAB worker holds its own cache, so that
+%   plans can be used from parallel workers without locking.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+global settings
+if isempty(settings)
+  pspm_init;
+end
+persistent cache
+if isempty(cache)
+  cache = containers.Map('KeyType', 'char', 'ValueType', 'any');
+end
+sts = -1;
+plan = struct();
+if nargin < 1
+  warning('ID:invalid_input', 'Not enough input arguments.'); return;
+elseif ischar(filt) && strcmpi(filt, 'clear')
+  cache = containers.Map('KeyType', 'char', 'ValueType', 'any');
+  sts = 1;
+  return
+elseif ~isstruct(filt) || ~all(isfield(filt, {'sr', 'lpfreq', 'lporder', 'hpfreq', 'hporder', 'direction'}))
+  warning('ID:invalid_input', 'filt structure has missing fields.'); return;
+end
+lpfreq = freq_or_nan(filt.lpfreq);
+hpfreq = freq_or_nan(filt.hpfreq);
+bi = strcmpi(filt.direction, 'bi');
+key = sprintf('%.17g|%.17g|%d|%.17g|%d|%d', filt.sr, lpfreq, filt.lporder, ...
+  hpfreq, filt.hporder, bi);
+if isKey(cache, key)
+  plan = cache(key);
+  sts = 1;
+  return
+end
+
+%% Design filters
+nyq = filt.sr / 2;
+plan.key = key;
+plan.lp = [];
+plan.hp = [];
+if ~isnan(lpfreq) && lpfreq < nyq
+  [lsts, plan.lp] = design(filt.lporder, lpfreq / nyq, 'low', bi);
+  if lsts < 1, return; end
+end
+if ~isnan(hpfreq)
+  [lsts, plan.hp] = design(filt.hporder, hpfreq / nyq, 'high', bi);
+  if lsts < 1, return; end
+end
+if cache.Count >= 100
+  cache = containers.Map('KeyType', 'char', 'ValueType', 'any');
+end
+cache(key) = plan;
+sts = 1;
+return
+
+function freq = freq_or_nan(freq)
+if ischar(freq)
+  freq = NaN;
+end
+
+function [sts, f] = design(order, freqratio, pass, bi)
+f = struct();
+[sts, sos, g] = pspm_butter(order, freqratio, pass, 'sos');
+if sts < 1
+  return
+end
+if size(sos, 1) == 1
+  % pspm_filtfilt takes a single section as transfer function; first
+  % order filters keep their first order padding
+  n = 3 - (sos(3) == 0 && sos(6) == 0);
+  f.b = sos(1:n);
+  f.a = sos(4:3 + n);
+else
+  f.b = sos;
+  f.a = g;
+end
+f.zi = [];
+if bi
+  [sts, f.zi] = pspm_filtfilt(f.b, f.a);
+end
@@ -1,13 +1,23 @@
-function [sts, y] = pspm_filtfilt(b,a,x)
+function [sts, y] = pspm_filtfilt(b,a,x,zi)
 % ● Description
 %   pspm_filtfilt. Zero-phase forward and reverse digital filtering
 % ● Format
 %   [sts, y] = pspm_filtfilt(b,a,x)
+%   [sts, y] = pspm_filtfilt(sos,g,x)
+%   [sts, y] = pspm_filtfilt(b,a,x,zi)
+%   [sts, zi] = pspm_filtfilt(b,a)
 %   y = pspm_filtfilt(b,a,x)
 % ● Arguments
 %   * b:  filter parameters (numerator)
 %   * a:  filter parameters (denominator)
+%   * sos:  second-order sections, an L x 6 matrix (L > 1) with one row
+%           [b0 b1 b2 1 a1 a2] per section
+%   * g:  gain of the second-order sections (scalar, or vector whose
+%         product is the overall gain)
 %   * x:  input data vector (if matrix, filter over columns)
+%   * zi:  [optional] steady-state initial conditions for a unit step, as
+%          returned by [sts, zi] = pspm_filtfilt(b,a). Pass them to avoid
+%          recomputing them when the same filter is applied repeatedly.
 %   * y:  filtered data
 % ● Developer's notes
 %   The filter is described by the difference equation:
@@ -20,7 +30,12 @@ function [sts, y] = pspm_filtfilt(b,a,x)
 %   magnitude response.  Care is taken to minimize startup and ending
 %   transients by matching initial conditions.
 %   The length of the input x must be more than three times
-%   the filter order, defined as max(length(b)-1,length(a)-1).
+%   the filter order, defined as max(length(b)-1,length(a)-1), or 2*L for
+%   second-order sections.
+%   All columns of a matrix x are filtered together, with one set of
+%   initial conditions per column. High-order filters are numerically more
+%   stable when given as second-order sections, which are run as a cascade
+%   of biquad filters with steady-state initial conditions per section.
 % ● References
 %   [1] Sanjit K. Mitra, Digital Signal Processing, 2nd ed, McGraw-Hill, 2001
 %   [2] Fredrik Gustafsson, Determining the initial states in forward-backward
@@ -41,54 +56,99 @@ end
 sts = -1;
 y = [];
 %% Check input data
-if nargin < 3
+if nargin < 2
   warning('ID:invalid_input','Not enough parameters were specified.'); return;
 end
-[m,n] = size(x);
-if n>1 && m>1
-  y = zeros(size(x));
-  for i=1:n
-    [~, y(:,i)] = pspm_filtfilt(b,a,x(:,i));
+is_sos = size(b,2) == 6 && size(b,1) > 1;
+if is_sos
+  %% Check second-order sections
+  if any(b(:,4) == 0)
+    warning('ID:invalid_input','Second-order sections must have a nonzero a0.'); return;
+  end
+  % normalise sections and fold the gain into the first one
+  sos = bsxfun(@rdivide, b, b(:,4));
+  sos(1,1:3) = prod(a(:)) * sos(1,1:3);
+  nfact = 6*size(sos,1);
+  if nargin < 4 || isempty(zi)
+    zi = sos_zi(sos);
+  end
+else
+  %% Check filter parameters
+  b  = b(:).';    a  = a(:).';
+  nb = length(b); na = length(a);
+  nfilt = max(nb,na);
+  if nb < nfilt, b(nfilt)=0; end
+  if na < nfilt, a(nfilt)=0; end
+  nfact = 3*(nfilt-1);
+  sos  = [b, a];
+  if nfilt == 1
+    zi = zeros(0,1);
+  elseif nargin < 4 || isempty(zi)
+    % Developer's Guide
+    %   Use sparse matrix to solve system of linear equations for initial
+    %   conditions zi are the steady-state states of the filter b(z)/a(z) in the
+    %   state-space implementation of the 'filter' command
+    rows = [1:nfilt-1  2:nfilt-1  1:nfilt-2];
+    cols = [ones(1,nfilt-1) 2:nfilt-1  2:nfilt-1];
+    data = [1+a(2) a(3:nfilt) ones(1,nfilt-2) -ones(1,nfilt-2)];
+    sp   = sparse(rows,cols,data);
+    zi   = sp \ (b(2:nfilt).' - a(2:nfilt).'*b(1));
   end
+end
+if nargin < 3
+  % only the initial conditions were requested
+  y = zi;
+  sts = 1;
   return
 end
+m = size(x,1);
 if m==1, x = x(:); end
 len = size(x,1);
-%% Check filter parameters
-b  = b(:).';    a  = a(:).';
-nb = length(b); na = length(a);
-nfilt = max(nb,na);
-if nb < nfilt, b(nfilt)=0; end
-if na < nfilt, a(nfilt)=0; end
-nfact = 3*(nfilt-1);
 if len <= nfact
   warning('ID:invalid_input','Data must have length more than 3 times filter order.'); return;
 end
-if nfilt == 1
-  y=x; return
+if nfact == 0
+  y = x;
+  if m == 1, y = y.'; end
+  sts = 1;
+  return
 end
 % Developer's Guide
-%   Use sparse matrix to solve system of linear equations for initial
-%   conditions zi are the steady-state states of the filter b(z)/a(z) in the
-%   state-space implementation of the 'filter' command
-rows = [1:nfilt-1  2:nfilt-1  1:nfilt-2];
-cols = [ones(1,nfilt-1) 2:nfilt-1  2:nfilt-1];
-data = [1+a(2) a(3:nfilt) ones(1,nfilt-2) -ones(1,nfilt-2)];
-sp   = sparse(rows,cols,data);
-zi   = sp \ (b(2:nfilt).' - a(2:nfilt).'*b(1));
-% Developer's Guide
 %   Extrapolate beginning and end of data sequence using a `reflection
 %   method`.  Slopes of original and extrapolated sequences match at the end
 %   points. This reduces end effects
-y    = [2*x(1)-x((nfact+1):-1:2);x;2*x(len)-x((len-1):-1:len-nfact)];
+y    = [bsxfun(@minus, 2*x(1,:), x((nfact+1):-1:2,:)); x; ...
+  bsxfun(@minus, 2*x(len,:), x((len-1):-1:len-nfact,:))];
+clear x
 %% Filter, reverse data, filter again, and reverse data again
-y    = filter(b,a,y,zi*y(1));
-y    = y(end:-1:1);
-y    = filter(b,a,y,zi*y(1));
-y    = y(end:-1:1);
+y    = cascade(sos, zi, y);
+y    = y(end:-1:1,:);
+y    = cascade(sos, zi, y);
+y    = y(end-nfact:-1:nfact+1,:);
 %% Reformat y
-y([1:nfact len+nfact+(1:nfact)]) = [];
 if m == 1, y = y.'; end
 %% Sort outputs
 sts = 1;
 return
+
+function y = cascade(sos, zi, y)
+% run all sections over all columns, with initial conditions scaled to the
+% first sample of each column
+y0 = y(1,:);
+nb = size(sos,2)/2;
+for k = 1:size(sos,1)
+  y = filter(sos(k,1:nb), sos(k,nb+1:end), y, zi(:,k) * y0);
+end
+
+function zi = sos_zi(sos)
+% steady-state states of each biquad for a unit step at the input of the
+% cascade, i.e. scaled by the DC gain of all preceding sections
+L = size(sos,1);
+zi = zeros(2,L);
+gain = 1;
+for k = 1:L
+  b = sos(k,1:3);
+  a = sos(k,4:6);
+  zi(:,k) = gain * ([1+a(2), -1; a(3), 1] \ (b(2:3).' - a(2:3).'*b(1)));
+  gain = gain * sum(b) / sum(a);
+end
@@ -76,6 +76,13 @@ function [sts, outchannel, outinfos] = pspm_find_sounds(fn, options)
 %   ├───.snd_markers : vector of begining of sound sound events
 %   └────────.delays : vector of delays between markers and detected sounds. Only
 %                      available with option 'diagnostics' turned on.
+% ● Developer's notes
+%   The sound power envelope, the merging of pulses into events and the
+%   edge detection are computed with running sums over the signal, so that
+%   each pass is linear in the number of samples. The envelope is computed
+%   once; lowering the threshold for expectedSoundCount only repeats the
+%   event detection. Markers are associated with sounds by a sorted
+%   lookup with pspm_bsearch.
 % ● History
 %   Introduced in PsPM 3.0
 %   Written in 2015 by Samuel Gerster (University of Zurich)
@@ -127,17 +134,15 @@ else
 end
 % Apply simple bidirectional square filter
 snd_pow = snd_pow-min(snd_pow);
-mask = ones(round(.01*snd.header.sr),1)/round(.01*snd.header.sr);
-snd_pow = conv(snd_pow,mask);
-snd_pow = sqrt(snd_pow(1:end-length(mask)+1).*snd_pow(length(mask):end));
+snd_pow = window_power(snd_pow, round(.01*snd.header.sr));
 
 %% Process roi option
 if isempty(options.roi)
   ll = 1;
   ul = length(snd.data);
 else
-  ll = dsearchn(t,options.roi(1));
-  ul = dsearchn(t,options.roi(2));
+  ll = pspm_bsearch(t,options.roi(1));
+  ul = pspm_bsearch(t,options.roi(2));
 end
 roi_mask = false(size(snd.data));
 roi_mask(ll:ul) = true;
@@ -145,37 +150,41 @@ loc_snd_pow = snd_pow;
 loc_snd_pow(~roi_mask) = 0;
 
 
+%% Triggers
+if options.diagnostics
+  [lsts, mkr] = pspm_load_channel(fn, options.marker_chan_num, 'marker');
+  if lsts == -1
+    return;
+  end
+end
+
 %% Find sound events
 searchForMoreSounds = true;
 while searchForMoreSounds == true
-  clear snd_pres
   thresh_l = max(loc_snd_pow)*options.threshold;
-  snd_pres(loc_snd_pow>thresh_l) = 1;
-  snd_pres(loc_snd_pow<=thresh_l) = 0;
   % Convert detected sounds into events. If pulses are separated by less than
   % 50ms, combine into one event.
-  mask = ones(round(0.05*snd.header.sr*options.resample),1);
-  n_pad = length(mask)-1;
-  c = conv(snd_pres,mask)>0;
-  snd_pres = (c(1:end-n_pad) & c(n_pad+1:end));
+  snd_pres = merge_pulses(loc_snd_pow>thresh_l, round(0.05*snd.header.sr*options.resample));
 
   % Find rising and falling edges
-  snd_re = t(conv([1,-1],snd_pres(1:end-1)+0)>0);
-  % Find falling edges
-  snd_fe = t(conv([1,-1],snd_pres(1:end-1)+0)<0);
-  if numel(snd_re) ~= 0 && numel(snd_fe) ~= 0
+  [i_re, i_fe] = find_edges(snd_pres);
+  if numel(i_re) ~= 0 && numel(i_fe) ~= 0
     % Start with a rising and end with a falling edge
-    if snd_re(1)>snd_fe(1)
-      snd_re = snd_re(2:end);
+    if i_re(1)>i_fe(1)
+      i_re = i_re(2:end);
     end
-    if snd_fe(end) < snd_re(end)
-      snd_fe = snd_fe(1:end-1);
+    if i_fe(end) < i_re(end)
+      i_fe = i_fe(1:end-1);
     end
   end
+  snd_re = t(i_re);
+  snd_fe = t(i_fe);
   % Discard sounds shorter than 10ms
   noevent_i = find((snd_fe-snd_re)<0.01);
   snd_re(noevent_i)=[];
   snd_fe(noevent_i)=[];
+  i_re(noevent_i)=[];
+  i_fe(noevent_i)=[];
 
   % find sound in sound
   if isstruct(options.snd_in_snd)
@@ -184,39 +193,35 @@ while searchForMoreSounds == true
 
     % go through all detected events
     clear snd_re_l snd_fe_l;
-    for i_re = 1:length(snd_re)
+    for i_event = 1:length(snd_re)
       % if the detected sound is too small to be a possible snd in
       % snd ignore and continue for loop
-      if (snd_fe(i_re) - snd_re(i_re)) < options.snd_in_snd.max_width
+      if (snd_fe(i_event) - snd_re(i_event)) < options.snd_in_snd.max_width
         continue
       end
 
       % get event's sound power, remoce DC component and normalize
-      loc_snd_pow_l = loc_snd_pow(t>snd_re(i_re) & t<snd_fe(i_re));
+      event_samples = (i_re(i_event)+1):(i_fe(i_event)-1);
+      loc_snd_pow_l = loc_snd_pow(event_samples);
       loc_snd_pow_l = loc_snd_pow_l-mean(loc_snd_pow_l);
       loc_snd_pow_l = loc_snd_pow_l/range(loc_snd_pow_l);
       % create time vector
-      t_l = t(t>snd_re(i_re) & t<snd_fe(i_re));
+      t_l = t(event_samples);
 
       thresh_l = options.snd_in_snd.threshold;
-      snd_pres_l = [];
-      snd_pres_l(loc_snd_pow_l>thresh_l) = 1;
-      snd_pres_l(loc_snd_pow_l<=thresh_l) = 0;
       % Convert detected sounds into events. If pulses are separated by less than
       % 10ms, combine into one event.
-      mask_l = ones(round(0.01*snd.header.sr*options.resample),1);
-      n_pad_l = length(mask_l)-1;
-      c_l = conv(snd_pres_l,mask_l)>0;
-      snd_pres_l = (c_l(1:end-n_pad_l) & c_l(n_pad_l+1:end));
+      snd_pres_l = merge_pulses(loc_snd_pow_l>thresh_l, round(0.01*snd.header.sr*options.resample));
 
       % Find rising and falling edges
       if sum(snd_pres_l)>0
-        snd_re_l(i_re) = t_l(conv([1,-1],snd_pres_l(1:end-1)+0)>0); %#ok<*AGROW>
+        [i_re_l, i_fe_l] = find_edges(snd_pres_l);
+        snd_re_l(i_event) = t_l(i_re_l); %#ok<*AGROW>
         % Find falling edges
-        snd_fe_l(i_re) = t_l(conv([1,-1],snd_pres_l(1:end-1)+0)<0);
+        snd_fe_l(i_event) = t_l(i_fe_l);
       else
-        snd_re_l(i_re)=NaN;
-        snd_fe_l(i_re)=NaN;
+        snd_re_l(i_event)=NaN;
+        snd_fe_l(i_event)=NaN;
       end
     end
     snd_re_l(isnan(snd_re_l))=[];
@@ -243,37 +248,26 @@ while searchForMoreSounds == true
   snd_re_all = snd_re;
   snd_fe_all = snd_fe;
 
-  %% Triggers
   if options.diagnostics
-    [lsts, mkr] = pspm_load_channel(fn, options.marker_chan_num, 'marker');
-    if lsts == -1
-      return;
-    end
-
     %% Estimate delays from trigger to sound
-    delays = nan(length(mkr.data),1);
-    snd_markers = nan(length(mkr.data),1);
-    for i=1:length(mkr.data)
-      % Find sound onset in region of interest
-      t_re = snd_re(find(snd_re>mkr.data(i)+options.mindelay,1));
-      delay = t_re-mkr.data(i);
-      if delay<options.maxdelay
-        delays(i) = delay;
-        snd_markers(i)=t_re;
-      end
+    % first sound onset after each marker plus mindelay
+    mkr_data = mkr.data(:);
+    if isempty(snd_re)
+      i_snd = zeros(0, 1);
+    else
+      i_snd = pspm_bsearch(snd_re, mkr_data+options.mindelay, 'floor')+1;
     end
-    delays(isnan(delays)) = [];
+    related = i_snd <= numel(snd_re);
+    related(related) = snd_re(i_snd(related))-mkr_data(related) < options.maxdelay;
+    i_snd = i_snd(related);
+    delays = snd_re(i_snd)-mkr_data(related);
     %if isempty(delays)
     %    warning('ID:out_of_range', 'Too strict max delay was set, no results would be generated.');
     %end
-    snd_markers(isnan(snd_markers)) = [];
+    snd_markers = snd_re(i_snd);
     % Discard any sound event not related to a trigger
-    if ~isempty(snd_fe)
-      snd_fe = snd_fe(dsearchn(snd_re,snd_markers));
-    end
-    if ~isempty(snd_re)
-      snd_re = snd_re(dsearchn(snd_re,snd_markers));
-    end
+    snd_fe = snd_fe(i_snd);
+    snd_re = snd_re(i_snd);
     %% Display some diagnostics
     fprintf(['%4d sound events associated with a marker found\n', ...
       'Mean Delay : %5.1f ms\nStd dev    : %5.1f ms\n'],...
@@ -388,3 +382,29 @@ end
 
 %% Return values
 sts = 1;
+return
+
+function env = window_power(p, w)
+% geometric mean of the moving average of p over the w preceding and the
+% w following samples, as the full convolution with a box of length w
+n = numel(p);
+c = [0; cumsum(p(:))];
+k = (1:n)';
+fwd = (c(k+1)-c(max(k-w+1, 1)))/w;
+bwd = (c(min(k+w-1, n)+1)-c(k))/w;
+env = sqrt(max(fwd.*bwd, 0));
+
+function pres = merge_pulses(pres, w)
+% keep samples that have a pulse within the w preceding and within the w
+% following samples, such that pulses less than w samples apart are merged
+n = numel(pres);
+c = [0; cumsum(pres(:))];
+k = (1:n)';
+pres = (c(k+1)-c(max(k-w+1, 1))) > 0 & (c(min(k+w-1, n)+1)-c(k)) > 0;
+
+function [i_re, i_fe] = find_edges(pres)
+% rising and falling edges of a logical vector; the last sample is not
+% considered, such that an event at the end of the data has a falling edge
+d = diff([0; pres(1:end-1); 0]);
+i_re = find(d > 0);
+i_fe = find(d < 0);
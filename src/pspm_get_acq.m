@@ -1,11 +1,11 @@
 function [sts, import, sourceinfo] = pspm_get_acq(datafile, import)
 % ● Description
 %   pspm_get_acq imports Biopac Acknowledge files from version 3.9.0 or
-%   lower. This function uses the conversion routine acqread.m version 2.0 (2007-08-21)
-%   by Sebastien Authier and Vincent Finnerty at the University of Montreal
-%   which supports all files created with Windows/PC versions of
-%   AcqKnowledge (3.9.0 or below), BSL (3.7.0 or below), and BSL PRO
-%   (3.7.0 or below).
+%   lower. This function uses the conversion routine import_acq.m, which
+%   follows acqread.m version 2.0 (2007-08-21) by Sebastien Authier and
+%   Vincent Finnerty at the University of Montreal and supports all files
+%   created with Windows/PC versions of AcqKnowledge (3.9.0 or below), BSL
+%   (3.7.0 or below), and BSL PRO (3.7.0 or below).
 % ● Format
 %   [sts, import, sourceinfo] = pspm_get_acq_python(datafile, import);
 % ● Arguments
@@ -21,7 +21,9 @@ function [sts, import, sourceinfo] = pspm_get_acq(datafile, import)
 %   * sourceinfo : The struct that saves information of original data source
 % ● Developer's Notes
 %   The main part of this function is shared with pspm_get_acq_python.
-%   The function acqread is stored in the path /Import/acq.
+%   The functions import_acq and acqread are stored in the path /Import/acq.
+%   import_acq reads the file in one call and de-interleaves all channels
+%   in one pass; acqread is kept for reference.
 % ● History
 %   Introduced in PsPM 3.0
 %   Written in 2011-2014 Dominik R Bach (Wellcome Trust Centre for Neuroimaging)
@@ -36,7 +38,11 @@ sts = -1;
 sourceinfo = [];
 addpath(pspm_path('Import','acq'));
 %% Load data
-[sts, header, inputdata] = evalc('acqread(datafile)');
+[lsts, header, inputdata] = import_acq(datafile);
+if lsts < 1
+  rmpath(pspm_path('Import','acq'));
+  return
+end
 %% Extract individual channels
 for k = 1:numel(import)
   % define channel number ---
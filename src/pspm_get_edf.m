@@ -1,16 +1,24 @@
 function [sts, import, sourceinfo] = pspm_get_edf(datafile, import)
 % ● Description
-%   pspm_get_edf imports European Data Format (EDF) files using FieldTrip 
-%   fileio functions.
+%   pspm_get_edf imports European Data Format (EDF and EDF+) files. Signal
+%   channels, EDF+ annotations and trigger flanks are read in a single pass
+%   over the data records by import_edf.
 % ● Format
 %   [sts, import, sourceinfo] = pspm_get_edf(datafile, import);
 % ● Arguments
 %   * datafile: the EDF data file to be imported
 %   *   import: the struct of import settings
+% ● Developer's Notes
+%   For event channels, channel 0 (default) imports the EDF+ annotations as
+%   markers, with the annotation text as marker name and duration in
+%   markerinfo.duration. A positive channel number refers to a signal
+%   channel that carries trigger levels; each ascending flank is then
+%   imported as a marker with the new signal level as marker value.
 % ● History
 %   Introduced in PsPM 3.0
 %   Written in 2008-2015 by Tobias Moser (University of Zurich)
 %   Maintained in 2022 by Teddy
+%   Updated in 2026 to use a native EDF+ reader instead of FieldTrip
 
 %% Initialise
 global settings
@@ -19,22 +27,22 @@ if isempty(settings)
 end
 sts = -1;
 sourceinfo = [];
-addpath(pspm_path('Import','fieldtrip','fileio'));
+addpath(pspm_path('Import','edf'));
 
 % get data
 % -------------------------------------------------------------------------
-w_state = warning('query');
-warning('off', 'all'); % unfortunately the warning is not issued with an ID
-hdr = ft_read_header(datafile);
-indata = ft_read_data(datafile);
-try mrk = ft_read_event(datafile, 'detectflank', []); catch, mrk = []; end;
-warning(w_state);
-
-
-% convert 3 dim to 2 dim (collapse all trials into continuous data)
-if numel(size(indata)) == 3,
-  indata = indata(:,:);
-end;
+% trigger channels are all positive channel numbers of event import jobs
+trigchan = [];
+for k = 1:numel(import)
+  if ~strcmpi(settings.channeltypes(import{k}.typeno).data, 'wave') && ...
+      isfield(import{k}, 'channel') && import{k}.channel > 0
+    trigchan(end + 1) = import{k}.channel;
+  end
+end
+[lsts, indata] = import_edf(datafile, trigchan);
+rmpath(pspm_path('Import','edf'));
+if lsts < 1, return; end
+hdr = indata.hdr;
 
 % extract individual channels
 % -------------------------------------------------------------------------
@@ -49,35 +57,51 @@ for k = 1:numel(import)
       if channel < 1, return; end;
     end;
 
-    if channel > size(indata, 1), warning('ID:channel_not_contained_in_file', 'Channel %02.0f not contained in file %s.\n', channel, datafile); return; end;
+    if channel > numel(hdr.label) || hdr.annotation(channel)
+      warning('ID:channel_not_contained_in_file', 'Channel %02.0f not contained in file %s.\n', channel, datafile); return;
+    end
 
     sourceinfo.channel{k, 1} = sprintf('Channel %02.0f: %s', channel, hdr.label{channel});
 
     % sample rate ---
-    import{k}.sr = hdr.Fs;
+    import{k}.sr = hdr.sr(channel);
 
     % get data ---
-    import{k}.data = indata(channel, :);
+    import{k}.data = indata.data{channel};
+    import{k}.units = hdr.units{channel};
 
   else                % event channels
-    % time unit
-    import{k}.sr = 1./hdr.Fs;
-
-    if ~isempty(mrk)
-      import{k}.data = [mrk(:).sample];
-      import{k}.marker = 'timestamps';
-      import{k}.markerinfo.value = pspm_struct2vec(mrk, 'value', 'marker');
-      import{k}.markerinfo.name = {mrk(:).type};
+    % onsets are given in seconds
+    import{k}.sr = 1;
+    import{k}.marker = 'timestamps';
+    if isfield(import{k}, 'channel') && import{k}.channel > 0
+      mrk = indata.triggers{find(trigchan == import{k}.channel, 1)};
+      import{k}.data = mrk.onset;
+      import{k}.markerinfo.value = mrk.value;
+      import{k}.markerinfo.name = arrayfun(@num2str, mrk.value, 'UniformOutput', false);
+      import{k}.markerinfo.duration = mrk.duration;
+      sourceinfo.channel{k, 1} = sprintf('Channel %02.0f: %s', import{k}.channel, hdr.label{import{k}.channel});
+    elseif ~isempty(indata.annotations.onset)
+      mrk = indata.annotations;
+      import{k}.data = mrk.onset;
+      % numeric annotations keep their value, text annotations are
+      % numbered by their unique label
+      [~, ~, labelno] = unique(mrk.label);
+      value = str2double(mrk.label);
+      value(isnan(value)) = labelno(isnan(value));
+      import{k}.markerinfo.value = value;
+      import{k}.markerinfo.name = mrk.label;
+      import{k}.markerinfo.duration = mrk.duration;
+      sourceinfo.channel{k, 1} = 'EDF Annotations';
     else
       warning('ID:channel_not_contained_in_file', ...
         'Marker channel not contained in file %s.\n', datafile); return;
-    end;
-  end;
+    end
+  end
 
-end;
+end
 
-% clear path and return
+% return
 % -------------------------------------------------------------------------
-rmpath(pspm_path('Import','fieldtrip','fileio'));
 sts = 1;
 return
@@ -488,17 +488,7 @@ switch model
      if lsts < 1, return; end
      % sort & merge missing epochs
     if size(missepochs, 1) > 0
-      [~, sortindx] = sort(missepochs(:, 1));
-      missepochs = missepochs(sortindx,:);
-      % check for overlap and merge
-      overlapindx = zeros(size(missepochs, 1), 1);
-      for k = 2:size(missepochs, 1)
-        if missepochs(k, 1) <= missepochs(k - 1, 2)
-          missepochs(k, 1) =  missepochs(k - 1, 1);
-          overlapindx(k - 1) = 1;
-        end
-      end
-      missepochs(logical(overlapindx), :) = [];
+      missepochs = pspm_intervals('merge', missepochs);
     end
     outtiming = missepochs;
 
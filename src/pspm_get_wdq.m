@@ -5,7 +5,8 @@ function [sts, import, sourceinfo] = pspm_get_wdq(datafile, import)
 %   ReadDataq.m provided by Dataq developers and contained in the PsPM 
 %   distribution. ActiveX control elements provided in the file activex.exe 
 %   provided by Dataq must be installed, too. The ActiveX plugin only runs 
-%   under 32 bit Matlab on Windows.
+%   under 32 bit Matlab on Windows; on other platforms, the portable
+%   reader pspm_get_wdq_n is used instead.
 % ● Format
 %   [sts, import, sourceinfo] = pspm_get_wdq(datafile, import);
 % ● Arguments
@@ -26,6 +27,10 @@ if isempty(settings)
 end
 sts = -1;
 sourceinfo = [];
+if ~ispc
+  [sts, import, sourceinfo] = pspm_get_wdq_n(datafile, import);
+  return
+end
 addpath(pspm_path('Import','wdq'));
 
 % get external file, using Dataq functions
@@ -28,6 +28,10 @@ function [sts, import, sourceinfo]  = pspm_get_wdq_n(datafile, import)
 %   information) as the ActiveX control elements do, but the function is
 %   independent of cpu architecture. Which means it does not require a 32-bit
 %   Matlab-Version.
+%   For event channels, channel 0 imports the event markers that WinDaq
+%   stores in the least significant bit of the first channel. In HiRes
+%   files, this bit is part of the sample, so no event markers are
+%   imported.
 % ● History
 %   Introduced in PsPM 3.0
 %   Written    in 2012-2015 by Tobias Moser (University of Zurich)
@@ -51,6 +55,18 @@ addpath(pspm_path('Import','nwdq'));
 % loop through import jobs
 for k = 1:numel(import)
   channel = import{k}.channel;
+  if strcmpi(settings.channeltypes(import{k}.typeno).data, 'events') && channel == 0
+    % event markers stored in the data stream
+    if inputinfo.hiResFile
+      warning('ID:no_event_markers', ['HiRes files do not store event ', ...
+        'markers in the data stream, no events are imported.']);
+    end
+    import{k}.sr = 1/inputinfo.sampleRatePerChannel;
+    import{k}.data = inputinfo.eventMarkers - 1;
+    import{k}.marker = 'timestamps';
+    sourceinfo.channel{k, 1} = 'Event markers';
+    continue
+  end
   if channel > size(inputdata, 2)
     warning('ID:channel_not_contained_in_file', 'Channel %1.0f does not exist in data file', channel); return;
   end;
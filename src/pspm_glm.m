@@ -257,7 +257,7 @@ try
   td = 1/model.filter.down;
   % model.bf.X contains the function values
   % bf_x contains the timestamps
-  [model.bf.X, bf_x] = feval(model.bf.fhandle, [td; model.bf.args(:)]);
+  [model.bf.X, bf_x] = basis_functions(model.bf.fhandle, [td; model.bf.args(:)], basepath);
   if strcmpi(model.latency, 'free') && size(model.bf.X,2) > 1
     warning('ID:invalid_input', ['With latency ''free'' multiple response ', ...
       'functions are not allowed.']); return;
@@ -398,9 +398,9 @@ for iSn = 1:nFile
   newmissing = zeros(size(newy(:)));
   if ~isempty(missing{iSn})
     missingtimes = pspm_time2index(missing{iSn},newsr,length(newmissing));
-    for iMs = 1:size(missingtimes, 1)
-      newmissing(missingtimes(iMs, 1):missingtimes(iMs, 2)) = 1;
-    end
+    % missing epochs include their last sample
+    newmissing = double(pspm_intervals('to_logical', ...
+      [missingtimes(:, 1), missingtimes(:, 2) + 1], length(newmissing)));
   end
   % copy NaN in y data should be missing
   newmissing(nan_idx) = 1;
@@ -524,18 +524,16 @@ for iCond = 1:numel(names)
   col=1;
   tmp.colnum=1+tmp.pmodno(iCond);
   tmp.X{iCond}=zeros(tmp.length, tmp.colnum);
-  for k = 1:numel(tmp.onsets)
-    tmp.X{iCond}(tmp.onsets(k):(tmp.onsets(k) + tmp.durations(k)), col)=1;
-  end
+  % samples covered by each event, and the event they belong to
+  [tmp.samples, tmp.event] = event_samples(tmp.onsets, tmp.durations);
+  tmp.X{iCond}(tmp.samples, col)=1;
   tmp.name{iCond, col}=names{iCond};
   col=col+1;
   if exist('pmod') && ~isempty(pmod)
     if iCond<=numel(pmod)
       if ~isempty(pmod(iCond).param)
         for p=1:numel(pmod(iCond).param)
-          for k = 1:numel(tmp.onsets)
-            tmp.X{iCond}(tmp.onsets(k):(tmp.onsets(k) + tmp.durations(k)), col)=pmod(iCond).param{p}(k);
-          end
+          tmp.X{iCond}(tmp.samples, col)=pmod(iCond).param{p}(tmp.event);
           tmp.name{iCond, col}=[names{iCond}, ' x ', pmod(iCond).name{p}];
           tmp.regscale{iCond}(col) = tmp.pmodscale(iCond, col - 1);
           col=col+1;
@@ -561,32 +559,25 @@ Xfilter.sr = glm.infos.sr;
 Xfilter.down = 'none'; % turn off downsampling
 Xfilter.lpfreq = NaN; % turn off low pass filter
 % 14.2 convolve with basis functions --
-snoffsets = cumsum(tmp.snduration);
-snonsets  = [1, snoffsets(1:end) + 1];
+% all onset functions are convolved and filtered in one call, session by
+% session
+tmp.X = cellfun(@(x) x(1:tmp.length, :), tmp.X, 'UniformOutput', false);
+[sts, tmp.XCall] = pspm_glm_convolve(cell2mat(tmp.X), tmp.snduration, glm.bf.X, Xfilter);
+if sts ~= 1, glm = struct([]);warning('ID:invalid_input', 'Failed to filter data');return; end
 tmp.XC = cell(1,numel(names));
 tmp.regscalec = cell(1,numel(names));
+iXCall = 0;
 for iCond = 1:numel(names)
-  tmp.XC{iCond} = [];
+  nXCcol = size(tmp.X{iCond}, 2) * glm.bf.bfno;
+  tmp.XC{iCond} = tmp.XCall(:, iXCall + (1:nXCcol));
+  iXCall = iXCall + nXCcol;
   tmp.regscalec{iCond} = [];
   iXCcol = 1;
   for iXcol = 1:size(tmp.X{iCond}, 2)
     for iBf = 1:glm.bf.bfno
-      % process each session individually
-      for iSn = 1:numel(tmp.snduration)
-        % convolve
-        tmp.col{iSn, 1} = conv(tmp.X{iCond}(snonsets(iSn):snoffsets(iSn), iXcol), glm.bf.X(:,iBf));
-        % filter design matrix w/o downsampling
-        [sts,  tmp.col{iSn, 1}, ~] = pspm_prepdata(tmp.col{iSn, 1}, Xfilter);
-        if sts ~= 1, glm = struct([]);warning('ID:invalid_input', 'Failed to filter data');return; end
-        % cut away tail
-        tmp.col{iSn, 1}((tmp.snduration(iSn) + 1):end) = [];
-      end
-      tmp.XC{iCond}(:, iXCcol) = cell2mat(tmp.col);
       tmp.namec{iCond}{iXCcol, 1} = [tmp.name{iCond, iXcol}, ', bf ', num2str(iBf)];
       tmp.regscalec{iCond} = [tmp.regscalec{iCond}, tmp.regscale{iCond}(iXcol)];
       iXCcol = iXCcol + 1;
-      % clear local variable
-      tmp.col = {};
     end
   end
   % 14.3 mean centering --
@@ -627,8 +618,9 @@ end
 for iSn = 1:numel(model.datafile)
   Rf{iSn} = [];
   model.filter.sr = sr(iSn);
-  for iR = 1:nR
-    [sts, Rf{iSn}(:, iR), ~]  = pspm_prepdata(R{iSn}(:, iR), model.filter);
+  if nR > 0
+    % filter all nuisance regressors together
+    [sts, Rf{iSn}, ~]  = pspm_prepdata(R{iSn}(:, 1:nR), model.filter);
     if sts ~= 1,warning('ID:invalid_input', 'Failed to filter data'); return; end
   end
   if (model.bf.shiftbf ~= 0) && ~isempty(Rf{iSn})
@@ -667,12 +659,13 @@ if perc_missing >= 0.1
       'which is possibly caused by downsampling. Results may be inaccurate.']);
   end
 end
-glm.YM = glm.Y;
-glm.YM(glm.M(1:length(glm.YM))==1) = [];
-glm.Y(glm.M(1:length(glm.Y))==1) = NaN;
-glm.XM = glm.X;
-glm.XM(glm.M(1:length(glm.XM))==1, :) = [];
-glm.X(glm.M(1:length(glm.X))==1, :) = NaN;
+% the rows of YM and XM are the samples with glm.M == 0
+tmp.missing = glm.M(1:length(glm.Y))==1;
+glm.YM = glm.Y(~tmp.missing);
+glm.Y(tmp.missing) = NaN;
+tmp.missing = glm.M(1:size(glm.X, 1))==1;
+glm.XM = glm.X(~tmp.missing, :);
+glm.X(tmp.missing, :) = NaN;
 glm.Yhat    = NaN(size(Y));
 % 14.8 clear local variables --
 clear tmp Xfilter r iSn n iCond
@@ -707,8 +700,9 @@ if strcmpi(model.latency, 'free')
   glm.XM = XMnew;
 end
 % 15.1 estimate amplitudes --
-glm.stats = pinv(glm.XM)*glm.YM;           % parameter estimates
-glm.Yhat(glm.M==0) = glm.XM*glm.stats;     % predicted response
+[sts, glm.stats, YhatM] = pspm_glm_solve(glm.XM, glm.YM); % parameter estimates
+if sts ~= 1, glm = struct([]); warning('ID:invalid_input', 'Failed to estimate the model'); return; end
+glm.Yhat(glm.M==0) = YhatM;                % predicted response
 glm.e    = glm.Y - glm.Yhat;               % residual error
 glm.EV   = 1 - (var(glm.e)/var(glm.YM));   % explained variance proportion
 
@@ -753,4 +747,36 @@ end
 glm.datetime = datetime;
 savedata = struct('glm', glm);
 [sts, data_load1, mdltype_load1] = pspm_load1(model.modelfile, 'save', savedata, options);
+return
+
+function [samples, event] = event_samples(onsets, durations)
+% samples onsets(k):(onsets(k) + durations(k)) of all events, and the
+% index k of the event each sample belongs to
+n = max(floor(durations(:)) + 1, 0);
+event = repelem((1:numel(onsets))', n);
+samples = onsets(event);
+samples = samples(:) + (1:sum(n))' - repelem(cumsum(n) - n, n) - 1;
 
+function [X, x] = basis_functions(fhandle, args, basepath)
+% evaluate a basis set, or take it from the cache if it was evaluated
+% before with the same arguments (e.g. for another subject)
+persistent cache
+if isempty(cache)
+  cache = containers.Map('KeyType', 'char', 'ValueType', 'any');
+end
+name = func2str(fhandle);
+key = sprintf('%s|%s|%s', basepath, name, sprintf('%.17g,', args));
+if isKey(cache, key)
+  bf = cache(key);
+else
+  [bf.X, bf.x] = feval(fhandle, args);
+  % anonymous functions may capture variables, and are not cached
+  if ~strncmp(name, '@', 1)
+    if cache.Count >= 20
+      cache = containers.Map('KeyType', 'char', 'ValueType', 'any');
+    end
+    cache(key) = bf;
+  end
+end
+X = bf.X;
+x = bf.x;
@@ -0,0 +1,135 @@
+function [sts, modelfiles, stats] = pspm_glm_batch(models, options)
+% ● Description
+%   pspm_glm_batch specifies and inverts a GLM for each of several
+%   subjects, and collects the parameter estimates of all subjects into
+%   one table. Basis functions and filters are evaluated once and shared
+%   between subjects with the same settings.
+% ● Format
+%   [sts, modelfiles, stats] = pspm_glm_batch(models, options)
+% ● Arguments
+%   *     models : cell array of model structures, one per subject, as
+%                  accepted by pspm_glm.
+%   ┌────options : [optional] passed on to pspm_glm, with the additional
+%   │              fields
+%   ├──.parallel : [optional, bool] estimate the models on the workers of a
+%   │              parallel pool. As the workers cannot open dialogs,
+%   │              existing model files are overwritten unless
+%   │              options.overwrite is set to 0. Default: 0.
+%   └────.target : [optional, string] name of a text file into which the
+%                  parameter estimates of all subjects are written with
+%                  pspm_export. Default: '' (no file is written).
+% ● Outputs
+%   *        sts : 1 if all models were estimated, -1 otherwise. Models
+%                  that could not be estimated are reported and skipped.
+%   * modelfiles : cell array of the model files that were written.
+%   *      stats : [matrix] subjects x parameters, the parameter estimates
+%                  of each subject, padded with NaN if models differ in
+%                  their number of parameters. Rows of models that could
+%                  not be estimated are NaN.
+% ● Developer's notes
+%   Basis function sets are cached by pspm_glm and filters by
+%   pspm_filter_plan, so that subjects with the same settings only pay for
+%   loading, filtering and solving their own data. With options.parallel,
+%   subjects are distributed over the workers of the current parallel pool,
+%   which is started if necessary; each worker keeps its own caches.
+%   Without a pool, subjects are processed one after the other.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+global settings
+if isempty(settings)
+  pspm_init;
+end
+sts = -1;
+modelfiles = {};
+stats = [];
+if nargin < 1
+  warning('ID:invalid_input', 'No models specified.'); return;
+elseif nargin < 2
+  options = struct();
+end
+if isstruct(models)
+  models = num2cell(models);
+end
+if ~iscell(models) || isempty(models) || ~all(cellfun(@isstruct, models))
+  warning('ID:invalid_input', 'Models must be a cell array of model structures.'); return;
+end
+options = pspm_options(options, 'glm_batch');
+if options.invalid
+  return
+end
+target = options.target;
+glm_options = rmfield(options, {'parallel', 'target'});
+n_workers = 0;
+if options.parallel
+  n_workers = parallel_workers;
+  % workers cannot ask whether to overwrite existing model files, and the
+  % sequential fallback behaves the same
+  if glm_options.overwrite == 2
+    glm_options.overwrite = 1;
+  end
+end
+
+%% Estimate models
+nModel = numel(models);
+ok = false(nModel, 1);
+allstats = cell(nModel, 1);
+pspm_settings = settings;
+if n_workers > 0
+  parfor (iModel = 1:nModel, n_workers)
+    [ok(iModel), allstats{iModel}] = estimate_model(models{iModel}, glm_options, pspm_settings);
+  end
+else
+  for iModel = 1:nModel
+    [ok(iModel), allstats{iModel}] = estimate_model(models{iModel}, glm_options, pspm_settings);
+  end
+end
+for iModel = find(~ok)'
+  warning('ID:invalid_input', 'Model %d could not be estimated.', iModel);
+end
+
+%% Collect parameter estimates
+nStats = max([0; cellfun(@numel, allstats)]);
+stats = NaN(nModel, nStats);
+for iModel = find(ok)'
+  stats(iModel, 1:numel(allstats{iModel})) = allstats{iModel};
+end
+modelfiles = cellfun(@(m) m.modelfile, models(ok), 'UniformOutput', false);
+if ~isempty(target) && ~isempty(modelfiles)
+  if pspm_export(modelfiles, struct('target', target)) ~= 1
+    warning('ID:invalid_input', 'Parameter estimates could not be exported.'); return;
+  end
+end
+if all(ok)
+  sts = 1;
+end
+return
+
+function [ok, stats] = estimate_model(model, options, pspm_settings)
+% estimate one model; this is also run on parallel workers, which do not
+% share the global settings
+global settings
+settings = pspm_settings;
+ok = false;
+stats = [];
+[sts, glm] = pspm_glm(model, options);
+if sts == 1 && ~isempty(glm)
+  ok = true;
+  stats = glm.stats(:)';
+end
+return
+
+function n_workers = parallel_workers
+% number of workers in the current parallel pool, which is started if
+% necessary; 0 if no pool is available
+n_workers = 0;
+try
+  pool = gcp;
+  if ~isempty(pool)
+    n_workers = pool.NumWorkers;
+  end
+catch
+  warning('ID:no_parallel_pool', 'Parallel pool not available, models are estimated sequentially.');
+end
+return
@@ -0,0 +1,76 @@
+function [sts, XC] = pspm_glm_convolve(X, snduration, bf, filt)
+% ● Description
+%   pspm_glm_convolve builds the convolved design matrix of pspm_glm: it
+%   convolves every onset function with every basis function, session by
+%   session, and filters the result. All columns of a session are
+%   convolved in the frequency domain and filtered together in one call of
+%   pspm_prepdata.
+% ● Format
+%   [sts, XC] = pspm_glm_convolve(X, snduration, bf, filt)
+% ● Arguments
+%   *          X : [matrix] onset functions (stick or box functions, possibly
+%                  parametrically modulated), one per column, with the
+%                  sessions concatenated along the rows.
+%   * snduration : [vector] number of samples of each session in X.
+%   *         bf : [matrix] basis functions, one per column.
+%   *       filt : [struct] filter settings for pspm_prepdata, without
+%                  downsampling.
+% ● Output
+%   *         XC : [matrix] sum(snduration) x (size(X, 2) * size(bf, 2))
+%                  design matrix. Column (k - 1) * size(bf, 2) + j holds
+%                  onset function k convolved with basis function j.
+% ● Developer's notes
+%   As with conv, each session is convolved to its full length, filtered,
+%   and then cut to the session length, so that the filter sees the tail
+%   of the convolution. Convolution uses one FFT per onset function and
+%   session for all basis functions.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+global settings
+if isempty(settings)
+  pspm_init;
+end
+sts = -1;
+XC = [];
+if nargin < 4
+  warning('ID:invalid_input', 'Not enough input arguments.'); return;
+elseif ~isnumeric(X) || ~isnumeric(bf) || isempty(bf)
+  warning('ID:invalid_input', 'Onset functions and basis functions must be numeric.'); return;
+end
+nbf = size(bf, 2);
+ncol = size(X, 2);
+XC = zeros(sum(snduration), ncol * nbf);
+if ncol == 0
+  sts = 1;
+  return
+elseif size(X, 1) < sum(snduration)
+  warning('ID:invalid_input', 'Onset functions are shorter than the sessions.'); return;
+end
+
+%% Convolve and filter each session
+snoffsets = cumsum(snduration(:))';
+snonsets = [1, snoffsets(1:end - 1) + 1];
+for iSn = 1:numel(snduration)
+  rows = snonsets(iSn):snoffsets(iSn);
+  nconv = snduration(iSn) + size(bf, 1) - 1;
+  nfft = 2^nextpow2(nconv);
+  F = fft(full(X(rows, :)), nfft);
+  B = fft(bf, nfft);
+  C = zeros(nconv, ncol * nbf);
+  for k = 1:ncol
+    if ~any(F(:, k))
+      continue
+    end
+    col = ifft(bsxfun(@times, F(:, k), B), 'symmetric');
+    C(:, (k - 1) * nbf + (1:nbf)) = col(1:nconv, :);
+  end
+  [lsts, C] = pspm_prepdata(C, filt);
+  if lsts ~= 1
+    warning('ID:invalid_input', 'Failed to filter data'); return;
+  end
+  XC(rows, :) = C(1:snduration(iSn), :);
+end
+sts = 1;
+return
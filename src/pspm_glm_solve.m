@@ -0,0 +1,88 @@
+function [sts, b, Yhat, e, s2, f] = pspm_glm_solve(X, Y, f)
+% ● Description
+%   pspm_glm_solve computes the least squares estimates of a linear model
+%   Y = X * b + e for one or several response columns, and returns fitted
+%   values, residuals and the residual variance from the same
+%   factorisation. The factorisation of the design matrix is returned, so
+%   that a caller fitting the same design to further data can pass it back
+%   instead of factorising the design again.
+% ● Format
+%   [sts, b, Yhat, e, s2, f] = pspm_glm_solve(X, Y)
+%   [sts, b, Yhat, e, s2, f] = pspm_glm_solve(X, Y, f)
+% ● Arguments
+%   *    X : [matrix] design matrix, observations x regressors.
+%   *    Y : [matrix] responses, observations x columns.
+%   *    f : [struct] OPTIONAL factorisation of X, as returned by a previous
+%            call with the same design matrix.
+% ● Output
+%   *  sts : 1 if the model could be estimated, -1 otherwise.
+%   *    b : [matrix] parameter estimates, regressors x columns. For rank
+%            deficient designs, the minimum norm solution, as pinv(X) * Y.
+%   * Yhat : [matrix] fitted values X * b.
+%   *    e : [matrix] residuals Y - Yhat.
+%   *   s2 : [row vector] residual variance of each column, the sum of
+%            squared residuals divided by the residual degrees of freedom.
+%   *    f : [struct] factorisation of X.
+% ● Developer's notes
+%   Full rank designs are solved with a column pivoted QR decomposition,
+%   which is cheaper than the singular value decomposition of pinv and as
+%   accurate. Rank deficient designs fall back to pinv. Nothing is kept
+%   between calls, such that the memory for the factorisation is released
+%   as soon as the caller discards it.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+sts = -1;
+b = [];
+Yhat = [];
+e = [];
+s2 = [];
+if nargin < 2
+  warning('ID:invalid_input', 'Not enough input arguments.'); return;
+elseif ~isnumeric(X) || ~isnumeric(Y) || ~ismatrix(X) || size(X, 1) ~= size(Y, 1)
+  warning('ID:invalid_input', 'X and Y must be numeric and have the same number of rows.'); return;
+elseif any(~isfinite(X(:)))
+  warning('ID:invalid_input', 'X must not contain NaN or Inf.'); return;
+elseif nargin > 2 && ~isempty(f) && (~isstruct(f) || ~isfield(f, 'size') || ...
+    ~isequal(f.size, size(X)))
+  warning('ID:invalid_input', 'f must be the factorisation of a design matrix of the size of X.'); return;
+end
+
+%% Factorise design
+if nargin < 3 || isempty(f)
+  f = factorise(X);
+end
+
+%% Solve
+if isempty(f.P)
+  QY = f.Q' * Y;
+  b = zeros(size(X, 2), size(Y, 2));
+  b(f.E, :) = f.R \ QY;
+  Yhat = f.Q * QY;
+else
+  b = f.P * Y;
+  Yhat = X * b;
+end
+e = Y - Yhat;
+s2 = sum(e.^2, 1) / max(size(X, 1) - f.rank, 1);
+sts = 1;
+return
+
+function f = factorise(X)
+% column pivoted QR decomposition, or pseudo-inverse if X is rank deficient
+f.size = size(X);
+[f.Q, f.R, f.E] = qr(X, 0);
+d = abs(diag(f.R));
+if isempty(d)
+  f.rank = 0;
+else
+  f.rank = sum(d > max(size(X)) * eps(d(1)));
+end
+f.P = [];
+if f.rank < size(X, 2)
+  f.P = pinv(X);
+  f.rank = rank(X);
+  f.Q = [];
+  f.R = [];
+end
@@ -3,108 +3,134 @@ function Y = pspm_interp1(varargin)
 %   pspm_interp1 is a shared PsPM function for interpolating data with NaNs
 %   based on the reference of missing epochs and first order interpolation.
 % ● Format
-%   Y = pspm_interp1(varargin)
+%   Y = pspm_interp1(X)
+%   Y = pspm_interp1(X, index_missing)
+%   Y = pspm_interp1(X, index_missing, method, extrapolate)
 % ● Arguments
-%   *             X : data that contains NaNs to be interpolated.
+%   *             X : data that contains NaNs to be interpolated. A vector,
+%                     or a matrix with one channel per column.
 %   * index_missing : index of missing epochs with the same size of X in binary values.
-%                     1 if NaNs, 0 if non-NaNs.
+%                     1 if NaNs, 0 if non-NaNs. Samples marked as missing
+%                     are interpolated in addition to NaNs. [optional]
+%   *        method : [optional] 'linear' (default), or any other method
+%                     accepted by interp1, e.g. 'pchip'.
+%   *   extrapolate : [optional] 1 (default): missing samples before the
+%                     first or after the last valid sample are
+%                     extrapolated; 0: they are left unchanged.
 %   *             Y : processed data.
+% ● Developer's notes
+%   For linear interpolation, the previous and next valid sample of every
+%   sample are found with a running maximum and minimum over sample
+%   indices, for all channels at once, so that the data are traversed once
+%   and no search is needed. Extrapolation continues the line through the
+%   first or last two valid samples. Other methods are passed on to interp1
+%   for each channel.
 % ● History
 %   Introduced in PsPM 6.1
 %   Written in 2023 by Teddy
 
 %% 1 Load inputs
-switch nargin
-  case 1
-    X = varargin{1};
-    index_missing = zeros(size(X));
-  case 2
-    X = varargin{1};
-    index_missing = varargin{2};
-  otherwise
-    warning('ID:invalid_input','pspm_interp1 accepts up to two arguments');
+if nargin < 1
+  warning('ID:invalid_input', 'pspm_interp1 needs at least one argument.');
+  Y = [];
+  return
+elseif nargin > 4
+  warning('ID:invalid_input', 'pspm_interp1 accepts up to four arguments.');
 end
-%% 2 Check inputs
-switch sum(~isnan(X))
-  case 0
-    % if there are no non-nans, do not process any interpolation, give a
-    % warning and return
-    warning('ID:invalid_input',...
-      'Input data contains only NaNs thus cannot be interpolated.')
-    Y = X;
-    return
-  case 1
-    % if there are only 1 non-nan, do not process any interpolation,
-    % give a warning and explain the reason
-    warning('ID:invalid_input',...
-      'Input data contains only 1 non-NaN thus cannot be interpolated.')
-    Y = X;
-    return
-  otherwise
-    % if there are less than 10^ non-nan, still perform interpolation,
-    % however give a warning and explain the reason
-    non_nan_percentage = sum(~isnan(X))/length(X);
-    if non_nan_percentage<0.1
-      warning('ID:invalid_input',...
-      'Input data contains less than 10% non-NaN. Interpolation can ',...
-      'still be performed but results could be inaccurate.')
-    end
+X = varargin{1};
+index_missing = [];
+method = 'linear';
+extrapolate = 1;
+if nargin >= 2
+  index_missing = varargin{2};
 end
-%% 3 find nan head and tail
-X_nan_head = 0;
-X_nan_tail = 0;
-X_nan_head_range = [];
-X_nan_tail_range = [];
-X_nan_head_interp = [];
-X_nan_tail_interp = [];
-index_non_nan_full = 1:length(X);
-index_non_nan_full = index_non_nan_full(~isnan(X));
-if index_non_nan_full(1) > 1
-  X_nan_head = 1;
-  X_nan_head_range = 1:(index_non_nan_full(1)-1);
+if nargin >= 3 && ~isempty(varargin{3})
+  method = varargin{3};
 end
-if index_non_nan_full(end) < length(X)
-  X_nan_tail = 1;
-  X_nan_tail_range = (index_non_nan_full(end)+1):length(X);
+if nargin >= 4 && ~isempty(varargin{4})
+  extrapolate = varargin{4};
 end
-X_body = X(index_non_nan_full(1):index_non_nan_full(end));
-% processing body
-index_nan = zeros(size(X_body));
-index_nan(isnan(X_body) | index_missing(index_non_nan_full(1):index_non_nan_full(end))) = 1;
-if any(index_nan)
-  X_body_interp = interp1(find(~index_nan),X_body(~index_nan), (1:numel(X_body))');
-else
-  X_body_interp = X_body;
+Y = X;
+is_row = isrow(Y);
+if is_row
+  Y = Y(:);
 end
-% interpolate head
-if X_nan_head
-  X_nan_head_interp = interp1(...
-    (1:length(X_body_interp))+length(X_nan_head_range),...
-    X_body_interp,...
-    X_nan_head_range,'linear','extrap');
+[n, m] = size(Y);
+missing = isnan(Y);
+if ~isempty(index_missing)
+  missing = missing | reshape(logical(index_missing), n, m);
 end
-% interpolate tail
-if X_nan_tail
-  X_nan_tail_interp = interp1(...
-    (1:length(X_body_interp))+length(X_nan_head_range),...
-    X_body_interp,...
-    X_nan_tail_range,'linear','extrap');
+%% 2 Check inputs
+n_valid = sum(~missing, 1);
+if any(n_valid == 0)
+  % if there are no non-nans, do not process any interpolation, give a
+  % warning and return
+  warning('ID:invalid_input',...
+    'Input data contains only NaNs thus cannot be interpolated.')
+elseif any(n_valid == 1)
+  % if there are only 1 non-nan, do not process any interpolation,
+  % give a warning and explain the reason
+  warning('ID:invalid_input',...
+    'Input data contains only 1 non-NaN thus cannot be interpolated.')
+elseif any(n_valid < 0.1 * n)
+  % if there are less than 10% non-nan, still perform interpolation,
+  % however give a warning and explain the reason
+  warning('ID:invalid_input', ['Input data contains less than 10%% non-NaN. ', ...
+    'Interpolation can still be performed but results could be inaccurate.'])
 end
-if iscolumn(X_body_interp)
-  if ~iscolumn(X_nan_head_interp)
-    X_nan_head_interp = transpose(X_nan_head_interp);
-  end
-  if ~iscolumn(X_nan_tail_interp)
-    X_nan_tail_interp = transpose(X_nan_tail_interp);
+% only channels with at least two valid samples are interpolated
+fill = find(bsxfun(@and, missing, n_valid >= 2));
+if isempty(fill)
+  Y = X;
+  return
+end
+%% 3 Interpolate
+if strcmpi(method, 'linear')
+  % previous and next valid sample of each sample, 0 or n + 1 if none
+  prv = repmat((1:n)', 1, m);
+  nxt = prv;
+  prv(missing) = 0;
+  nxt(missing) = n + 1;
+  prv = cummax(prv, 1);
+  nxt = cummin(nxt, 1, 'reverse');
+  col = ceil(fill / n);
+  ofs = (col - 1) * n;
+  lo = prv(fill);
+  hi = nxt(fill);
+  head = lo == 0;
+  tail = hi == n + 1;
+  if extrapolate
+    % first two and last two valid samples of each channel
+    first = nxt(1, :);
+    second = nxt((0:m - 1) * n + min(first + 1, n));
+    last = prv(n, :);
+    second_last = prv((0:m - 1) * n + max(last - 1, 1));
+    lo(head) = first(col(head));
+    hi(head) = second(col(head));
+    lo(tail) = second_last(col(tail));
+    hi(tail) = last(col(tail));
+  else
+    keep = ~head & ~tail;
+    fill = fill(keep);
+    ofs = ofs(keep);
+    lo = lo(keep);
+    hi = hi(keep);
   end
-  Y = [X_nan_head_interp; X_body_interp; X_nan_tail_interp];
+  pos = fill - ofs;
+  Y(fill) = Y(lo + ofs) + (pos - lo) .* (Y(hi + ofs) - Y(lo + ofs)) ./ (hi - lo);
 else
-  if iscolumn(X_nan_head_interp)
-    X_nan_head_interp = transpose(X_nan_head_interp);
-  end
-  if iscolumn(X_nan_tail_interp)
-    X_nan_tail_interp = transpose(X_nan_tail_interp);
+  for j = find(n_valid >= 2)
+    v = find(~missing(:, j));
+    q = find(missing(:, j));
+    if extrapolate
+      Y(q, j) = interp1(v, Y(v, j), q, method, 'extrap');
+    else
+      q = q(q > v(1) & q < v(end));
+      Y(q, j) = interp1(v, Y(v, j), q, method);
+    end
   end
-  Y = [X_nan_head_interp, X_body_interp, X_nan_tail_interp];
+end
+if is_row
+  Y = Y.';
 end
 return
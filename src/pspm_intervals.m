@@ -0,0 +1,116 @@
+function out = pspm_intervals(op, varargin)
+% ● Description
+%   pspm_intervals is a shared PsPM function for operations on sets of
+%   epochs, given as sorted lists of intervals instead of logical vectors
+%   over all samples. It is used by pspm_epochs2logical,
+%   pspm_logical2epochs, pspm_expand_epochs, pspm_get_timing, pspm_scr_pp
+%   and the eye tracker importers. This is an internal function with few
+%   input checks.
+% ● Format
+%   epochs = pspm_intervals('merge', epochs)
+%   epochs = pspm_intervals('expand', epochs, [pre, post])
+%   epochs = pspm_intervals('intersect', epochs, epochs2)
+%   epochs = pspm_intervals('complement', epochs, [lo, hi])
+%   epochs = pspm_intervals('clip', epochs, [lo, hi])
+%   index  = pspm_intervals('to_logical', epochs, datalength)
+%   epochs = pspm_intervals('from_logical', index)
+% ● Arguments
+%   *         op : operation, one of
+%                  'merge': sort epochs and merge overlapping or adjacent
+%                  epochs (union).
+%                  'expand': extend each epoch by pre before its onset and
+%                  post after its offset, and merge the result.
+%                  'intersect': the parts of time covered by both epochs
+%                  and epochs2, as merged epochs.
+%                  'complement': the gaps between epochs within [lo, hi].
+%                  'clip': restrict each epoch to [lo, hi], and remove
+%                  epochs that are empty after clipping. Epochs are not
+%                  merged.
+%                  'to_logical': logical index of length datalength, true
+%                  for samples onset:(offset - 1) of each epoch. Epochs
+%                  must be given in samples.
+%                  'from_logical': epochs [onset, offset] in samples, where
+%                  offset is the first sample after each run of true
+%                  values in the index.
+%   *     epochs : nx2 matrix of onsets and offsets.
+%   *    epochs2 : mx2 matrix of onsets and offsets.
+%   * datalength : length of the logical index.
+%   *      index : logical or numeric (0/1) vector.
+% ● Output
+%   *        out : nx2 epoch matrix, sorted by onset, or logical column
+%                  vector for 'to_logical'.
+% ● Developer's notes
+%   All operations work on the epoch list and take O(n log n) time for n
+%   epochs; only 'to_logical' and 'from_logical' touch the full data length,
+%   in a single pass. Epochs are half-open, such that [1, 3] and [3, 5]
+%   are adjacent and do not intersect.
+% ● History
+%   Introduced in PsPM 7.1
+
+switch lower(op)
+  case 'merge'
+    out = merge(varargin{1});
+  case 'expand'
+    epochs = varargin{1};
+    ex = varargin{2};
+    out = merge([epochs(:, 1) - ex(1), epochs(:, 2) + ex(2)]);
+  case 'intersect'
+    out = intersect_epochs(merge(varargin{1}), merge(varargin{2}));
+  case 'complement'
+    epochs = merge(varargin{1});
+    range = varargin{2};
+    out = [[range(1); epochs(:, 2)], [epochs(:, 1); range(2)]];
+    out(:, 1) = max(out(:, 1), range(1));
+    out(:, 2) = min(out(:, 2), range(2));
+    out = out(out(:, 2) > out(:, 1), :);
+  case 'clip'
+    out = varargin{1};
+    range = varargin{2};
+    out(:, 1) = max(out(:, 1), range(1));
+    out(:, 2) = min(out(:, 2), range(2));
+    out = out(out(:, 2) > out(:, 1), :);
+  case 'to_logical'
+    epochs = varargin{1};
+    n = varargin{2};
+    if isempty(epochs)
+      out = false(n, 1);
+      return
+    end
+    % mark onsets with +1 and offsets with -1, and integrate
+    on = max(epochs(:, 1), 1);
+    off = min(epochs(:, 2), n + 1);
+    keep = on < off;
+    flanks = accumarray([on(keep); off(keep)], ...
+      [ones(sum(keep), 1); -ones(sum(keep), 1)], [n + 1, 1]);
+    out = cumsum(flanks(1:n)) > 0;
+  case 'from_logical'
+    d = diff([0; varargin{1}(:) ~= 0; 0]);
+    out = [find(d == 1), find(d == -1)];
+  otherwise
+    warning('ID:invalid_input', 'Unknown operation ''%s''.', op);
+    out = [];
+end
+return
+
+function out = merge(epochs)
+% sort by onset, and start a new epoch wherever the onset is after the
+% latest offset so far
+out = zeros(0, 2);
+if isempty(epochs)
+  return
+end
+epochs = sortrows(epochs, 1);
+last_offset = cummax(epochs(:, 2));
+start = [true; epochs(2:end, 1) > last_offset(1:end - 1)];
+stop = [start(2:end); true];
+out = [epochs(start, 1), last_offset(stop)];
+
+function out = intersect_epochs(a, b)
+% sweep over the flanks of two merged epoch lists, with offsets before
+% onsets at equal times; time is covered by both lists where the count of
+% open epochs reaches 2, until the next flank
+flanks = sortrows([a(:, 1), ones(size(a, 1), 1); a(:, 2), -ones(size(a, 1), 1); ...
+  b(:, 1), ones(size(b, 1), 1); b(:, 2), -ones(size(b, 1), 1)]);
+both = find(cumsum(flanks(:, 2)) == 2);
+out = [flanks(both, 1), flanks(both + 1, 1)];
+out = out(out(:, 2) > out(:, 1), :);
@@ -2,21 +2,68 @@ function filtered_data = pspm_leaky_integrator(data, tau)
 % ● Description
 %   pspm_leaky_integrator applies a leaky integrator filter to the input data
 % ● Arguments
-%   * data: A numerical vector representing the input signal to be filtered.
+%   * data: A numerical vector representing the input signal to be filtered,
+%        or a matrix with one channel per column.
 %   * tau: The time constant of the leaky integrator, representing the
 %        leak rate. The leak constant defines how quickly previous values
 %        "leak out" of the integrator (or decay). A higher tau value
 %        results in slower decay, meaning the integrator has a longer memory.
+%        A scalar, a row vector with one value per channel, or a column
+%        vector (or matrix) with one value per sample for a time-varying
+%        time constant. For row vector data, a time-varying time constant
+%        is a row vector of the same length.
 % ● Output
 %   * filtered_data: The filtered signal, of the same size as the input data,
-%                 processed by the leaky integrator.
+%                 processed by the leaky integrator. Empty if tau is
+%                 invalid.
+% ● Developer's notes
+%   The integrator is the first order recursive filter
+%   y(i) = y(i - 1) + (x(i) - y(i - 1)) / tau(i), with y(1) = x(1).
+%   Constant time constants are run through filter, with the initial state
+%   set such that the first output equals the first input. Time-varying
+%   time constants are run sample by sample, for all channels at once.
 
-    % Initialize the filteredData vector with the same size as input data
-    filtered_data = zeros(size(data));
-    % Start with the first value of the input data
-    filtered_data(1) = data(1);
-    % Apply the leaky integrator formula to each data point
-    for i = 2:length(data)
-        filtered_data(i) = filtered_data(i - 1) + (data(i) - filtered_data(i - 1)) / tau;
+    filtered_data = [];
+    if ~isnumeric(tau) || isempty(tau) || any(tau(:) <= 0)
+        warning('ID:invalid_input', 'Tau must be positive.'); return;
+    end
+    is_row = isrow(data);
+    if is_row
+        if numel(tau) == numel(data)
+            % one time constant per sample, given as a row like the data
+            tau = tau(:);
+        end
+        data = data(:);
+    end
+    [n, m] = size(data);
+    if n == 0
+        filtered_data = data;
+        return
+    end
+    if isscalar(tau) || (size(tau, 1) == 1 && size(tau, 2) == m && n > 1)
+        % one time constant per channel
+        if isscalar(tau)
+            tau = repmat(tau, 1, m);
+        end
+        filtered_data = zeros(n, m);
+        for u = unique(tau)
+            cols = tau == u;
+            k = 1 / u;
+            filtered_data(:, cols) = filter(k, [1, k - 1], data(:, cols), ...
+                (1 - k) * data(1, cols));
+        end
+    elseif size(tau, 1) == n && any(size(tau, 2) == [1, m])
+        % time-varying time constant
+        k = 1 ./ tau;
+        filtered_data = data;
+        for i = 2:n
+            filtered_data(i, :) = filtered_data(i - 1, :) + ...
+                (data(i, :) - filtered_data(i - 1, :)) .* k(i, :);
+        end
+    else
+        warning('ID:invalid_input', 'Tau must be a scalar, or match the size of the data.'); return;
+    end
+    if is_row
+        filtered_data = filtered_data.';
     end
 end
@@ -14,18 +14,9 @@ function epochs = pspm_logical2epochs(index, sr)
     %   Written in 2024 by Bernhard Agoué von Raußendorf
 
     
-    % Compute the differences between consecutive elements in the index array,
-    % with padding at the start and end
-    diff_index = diff([0; index(:); 0]);
-    
-    % Onsets are where the difference is 1 (0 to 1 transition)
-    onsets = find(diff_index == 1);
-    
-    % Offsets are where the difference is -1 (1 to 0 transition)
-    offsets = find(diff_index == -1);
-    
-    % Combine onsets and offsets into an nx2 matrix
-    epochs = double([onsets, offsets]);
+    % Onsets are 0 to 1 transitions, offsets the first sample after a
+    % 1 to 0 transition
+    epochs = double(pspm_intervals('from_logical', index));
 
     % If the sample rate (sr) is not 1, convert indices back to time
     if nargin > 1 && sr ~= 1
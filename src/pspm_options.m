@@ -136,6 +136,8 @@ switch FunName
     options = autofill(options, 'nosave',                 0,          1                 );
     % Don't save dcm structure (e.g. used by pspm_get_rf)
     options = autofill(options, 'overwrite',              2,          [0,1]             );
+    options = autofill(options, 'parallel',               0,          1                 );
+    % invert trial windows on the workers of a parallel pool
     options = autofill(options, 'rf',                     0,          1                 );
     % Call an external file to provide response function (for use when this is previously
     % estimated by pspm_get_rf)
@@ -149,9 +151,13 @@ switch FunName
     % sf-free window after last event (second)
     options = autofill(options, 'sfpre',                  2,          '>=', 0           );
     % sf-free window before first event (second)
+    options = autofill(options, 'speculative_tol',        1e-3,       '>=', 0           );
+    % tolerance for accepting speculative initial states and priors in parallel inversion
     options = autofill(options, 'trlnames',               {},         '*Cell*Char'      );
     % Cell array of names for individual trials, is used for contrast manager only (e.g.
     % condition descriptions)
+    options = autofill(options, 'vb_backend',             'vba',      {'vba', 'pspm'}   );
+    % Gauss-Newton update of the VB inversion: VBA_Iphi or pspm_dcm_iphi
   case 'dcm_inv'
     % 2.17 pspm_dcm_inv --
     options = autofill(options, 'aSCR_sigma_offset',      0.1,        '*Num'            );
@@ -168,6 +174,8 @@ switch FunName
     options = autofill(options, 'meanSCR',                0,          '*Num'            );
     % data to adjust the response amplitude priors to
     options = autofill(options, 'overwrite',              2,          [0,1]             );
+    options = autofill(options, 'parallel',               0,          1                 );
+    % invert trial windows on the workers of a parallel pool
     options = autofill(options, 'sclpost',                2,          '>=', 0           );
     % scl-change-free window after last event (second)
     options = autofill(options, 'sclpre',                 2.5,        '>=', 0           );
@@ -179,8 +187,12 @@ switch FunName
     % sf-free window after last event (second)
     options = autofill(options, 'sfpre',                  2,          '>=', 0           );
     % sf-free window before first event (second)
+    options = autofill(options, 'speculative_tol',        1e-3,       '>=', 0           );
+    % tolerance for accepting speculative initial states and priors in parallel inversion
     options = autofill(options, 'rf',                     0,          1                 );
     % use pre-specified RF, provided in file, or as 4-element vector in log parameter space
+    options = autofill(options, 'vb_backend',             'vba',      {'vba', 'pspm'}   );
+    % Gauss-Newton update of the VB inversion: VBA_Iphi or pspm_dcm_iphi
   case 'down'
     % 2.18 pspm_down --
     options = autofill(options, 'overwrite',              2,          [0,1]             );
@@ -267,6 +279,12 @@ switch FunName
       end
     end
     options = fill_glm(options);
+  case 'glm_batch'
+    % 2.28.1 pspm_glm_batch --
+    options = autofill(options, 'overwrite',              2,          [0,1]             );
+    options = autofill(options, 'parallel',               0,          1                 );
+    % estimate the models on the workers of a parallel pool
+    options = autofill(options, 'target',                 '',         '*Char'           );
   case 'import'
     %% 2.29 pspm_import
     options = autofill(options, 'overwrite',              2,          [0,1]             );
@@ -305,6 +323,7 @@ switch FunName
     options = autofill_channel_action(options);
   case 'prepdata'
     options = autofill(options, 'fillnan',                1,          0                 );
+    options = autofill(options, 'blocksize',              0,          '>=', 0           );
   case 'process_illuminance'
     % 2.35 pspm_process_illuminance --
     options = autofill(options, 'bf',                     struct(),   '*Struct'         );
@@ -410,6 +429,8 @@ if ~isempty(options.missing_epochs_filename)
                                                           1.5339, ...
                                                           1.6411756741, ...
                                                           ],          '*Num'            );
+    options = autofill(options,'vb_backend',              'vba',      {'vba', 'pspm'}   );
+    % Gauss-Newton update of the SF-DCM inversion: VBA_Iphi or pspm_dcm_iphi
   case 'sf_dcm'
     % 2.43 pspm_sf_dcm --
     options = autofill(options,'dispwin',                 1,          0                 );
@@ -422,6 +443,8 @@ if ~isempty(options.missing_epochs_filename)
                                                           1.5339, ...
                                                           1.6411756741, ...
                                                           ],          '*Num'            );
+    options = autofill(options,'vb_backend',              'vba',      {'vba', 'pspm'}   );
+    % Gauss-Newton update of the SF-DCM inversion: VBA_Iphi or pspm_dcm_iphi
   case 'sf_mp'
     % 2.44 pspm_sf_mp --
     options = autofill(options,'diagnostics',             0,          1                 );
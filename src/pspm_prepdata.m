@@ -8,7 +8,8 @@ function [sts, data, newsr] = pspm_prepdata(varargin)
 %   [sts, data, newsr] = pspm_prepdata(data, filt)
 %   [sts, data, newsr] = pspm_prepdata(data, filt, options)
 % ● Arguments
-%   *      data:  a column vector of data
+%   *      data:  a column vector of data, or a matrix with one channel
+%                 per column; all channels are filtered together
 %   ┌──────filt
 %   ├───────.sr:  current sample rate in Hz
 %   ├───.lpfreq:  low pass filt frequency or 'none'
@@ -18,7 +19,15 @@ function [sts, data, newsr] = pspm_prepdata(varargin)
 %   ├.direction:  filt direction
 %   └─────.down:  sample rate in Hz after downsampling or 'none'
 %   ┌───options
-%   └──.fillnan:  0/1 specify whether to fill nan if there is. Default: 1
+%   ├──.fillnan:  0/1 specify whether to fill nan if there is. Default: 1
+%   └.blocksize:  [optional] number of samples to process at a time. If
+%                 non-zero and smaller than the data, NaN filling,
+%                 filtering and integer downsampling are done block by
+%                 block, so that memory use does not grow with the length
+%                 of the data. Only used for single channel data. Unidirectional results are identical to
+%                 processing the data at once; bidirectional results agree
+%                 up to the decayed filter response. Default: 0 (process
+%                 data at once).
 % ● Developer's Notes
 %   Note that the order for bandpass and bandstop filters is equal to
 %   order = lporder + hporder
@@ -70,30 +79,24 @@ elseif ((~isnumeric(filt.lpfreq) && (~ischar(filt.lpfreq) || ~strcmpi(filt.lpfre
   return;
 end
 uni = strcmpi(filt.direction, 'uni');
-%% Preprocessing data for nan
-if any(isnan(data))
-  if options.fillnan
-    data_index = 1:length(data);
-    data_nan_index = data_index(isnan(data));
-    data = pspm_interp1(data);
-  else
-    warning('ID:invalid_input', ...
+% transform data into column
+if isvector(data)
+  data = data(:);
+end
+n = size(data, 1);
+blockwise = options.blocksize > 0 && n > options.blocksize && size(data, 2) == 1;
+%% Check data for nan
+has_nan = any(isnan(data(:)));
+if has_nan && ~options.fillnan
+  warning('ID:invalid_input', ...
     ['Data contains NaN values but filling nan is not allowed. ',...
     'Processing cannot be performed.']);
-    return
-  end
+  return
 end
-%% Prepare data
+%% Prepare filters
 % determine nyquist frequency
 nyq = filt.sr/2;
-% transform data into column
-data = data(:);
-% if unidirectional, append data to avoid filter ringing
-if uni
-  data = [data(1) * ones(floor(50 * filt.sr), 1); data];
-end
 lowpass_filt = false;
-%% Lowpass filt
 if ~ischar(filt.lpfreq) && ~isnan(filt.lpfreq)
   lowpass_filt = true;
 elseif isnumeric(filt.down) && ~isnan(filt.down) && filt.down < filt.sr
@@ -103,47 +106,22 @@ elseif isnumeric(filt.down) && ~isnan(filt.down) && filt.down < filt.sr
   filt.lpfreq = filt.down/2;
   filt.lporder = 1;
 end
-if lowpass_filt
-  if filt.lpfreq >= nyq
-    warning('ID:no_low_pass_filtering', ...
-      'The low pass filter cutoff frequency is higher (or equal) than the nyquist frequency. The data won''t be low pass filtered!');
-  else
-    [lsts, filt.b, filt.a]=pspm_butter(filt.lporder, filt.lpfreq/nyq, 'low');
-    if lsts == -1
-      warning('ID:invalid_input', 'call of pspm_butter failed');
-      return;
-    end
-    if uni
-      data = filter(filt.b, filt.a, data);
-      data = filter(filt.b, filt.a, data);
-    else
-      [~, data] = pspm_filtfilt(filt.b, filt.a, data);
-    end
-  end
-end
-%% Highpass filt
-if ~ischar(filt.hpfreq) && ~isnan(filt.hpfreq)
-  [lsts, filt.b, filt.a]=pspm_butter(filt.hporder, filt.hpfreq/nyq, 'high');
-  if lsts == -1
-    warning('ID:invalid_input', 'call of pspm_butter failed');
-    return;
-  end
-  if uni
-    data = filter(filt.b, filt.a, data);
-    data = filter(filt.b, filt.a, data);
-  else
-    [~, data] = pspm_filtfilt(filt.b, filt.a, data);
-  end
-end
-% if uni, remove dummy data
-if uni
-  data = data((floor(50 * filt.sr) + 1):end);
+if ~lowpass_filt
+  filt.lpfreq = NaN;
+elseif filt.lpfreq >= nyq
+  warning('ID:no_low_pass_filtering', ...
+    'The low pass filter cutoff frequency is higher (or equal) than the nyquist frequency. The data won''t be low pass filtered!');
 end
-%% Downsample
-if exist('data_nan_index','var')
-  data(data_nan_index) = NaN; % reverse filled values back to nan if necessary
+% filters are designed once per specification and then taken from the
+% cache of pspm_filter_plan
+[lsts, plan] = pspm_filter_plan(filt);
+if lsts == -1
+  warning('ID:invalid_input', 'call of pspm_butter failed');
+  return;
 end
-if ~ischar(filt.down) && filt.sr > filt.down
+%% Determine downsampling
+down = ~ischar(filt.down) && filt.sr > filt.down;
+if down
   if strcmpi(filt.lpfreq, 'none') || isnan(filt.lpfreq)
     warning('No low pass filter applied - aliasing is possible. Use a low pass filter to prevent.');
   elseif filt.down < 2 * filt.lpfreq
@@ -151,10 +129,43 @@ if ~ischar(filt.down) && filt.sr > filt.down
     warning('ID:freq_change', ...
       'Sampling rate was changed to %01.2f Hz to prevent aliasing', filt.down)
   end
+end
+%% Filter
+if blockwise
+  % integer downsampling is done block by block, any other ratio on the
+  % filtered data
+  freqratio = 1;
+  if down && filt.sr / filt.down == ceil(filt.sr / filt.down)
+    freqratio = filt.sr / filt.down;
+    down = false;
+  end
+  data = filter_blocks(data, plan, uni, floor(50 * filt.sr), ...
+    options.blocksize, freqratio);
+else
+  if has_nan
+    data_nan_index = find(isnan(data));
+    data = pspm_interp1(data);
+  end
+  if uni
+    % append data to avoid filter ringing, and remove it after filtering
+    npad = floor(50 * filt.sr);
+    data = uni_filter(plan, [repmat(data(1, :), npad, 1); data], {});
+    data = data((npad + 1):end, :);
+  else
+    data = bi_filter(plan, data);
+  end
+  if has_nan
+    data(data_nan_index) = NaN; % reverse filled values back to nan if necessary
+  end
+end
+%% Downsample
+if down
   [lsts, data, newsr] = pspm_downsample(data, filt.sr, filt.down);
   if lsts == -1
     return
   end
+elseif ~ischar(filt.down) && filt.sr > filt.down
+  newsr = filt.down;
 else
   newsr = filt.sr;
 end
@@ -162,3 +173,142 @@ end
 outdata = data;
 sts = 1;
 return
+
+function [y, z] = uni_filter(plan, y, z)
+% unidirectional filtering: each filter is applied twice, second-order
+% sections run as a cascade; z holds the filter states of all stages, so
+% that consecutive blocks give the same result as one long signal
+stage = 0;
+for f = {plan.lp, plan.hp}
+  if isempty(f{1})
+    continue
+  end
+  b = f{1}.b;
+  a = f{1}.a;
+  for pass = 1:2
+    if size(b, 1) > 1
+      y = prod(a) * y;
+      for k = 1:size(b, 1)
+        stage = stage + 1;
+        [y, z{stage}] = filter(b(k, 1:3), b(k, 4:6), y, state(z, stage));
+      end
+    else
+      stage = stage + 1;
+      [y, z{stage}] = filter(b, a, y, state(z, stage));
+    end
+  end
+end
+
+function zi = state(z, stage)
+zi = [];
+if stage <= numel(z)
+  zi = z{stage};
+end
+
+function y = bi_filter(plan, y)
+for f = {plan.lp, plan.hp}
+  if ~isempty(f{1})
+    [~, y] = pspm_filtfilt(f{1}.b, f{1}.a, y, f{1}.zi);
+  end
+end
+
+function out = filter_blocks(data, plan, uni, npad, blocksize, freqratio)
+% filter_blocks runs NaN filling, filtering and integer downsampling on
+% consecutive blocks of data, such that intermediate results never exceed
+% a few blocks. Unidirectional filters carry their states from block to
+% block. Bidirectional filters are applied to each block extended by a
+% margin on both sides, over which the filter response has decayed, and
+% only the centre of each block is kept (overlap-save).
+n = numel(data);
+out = zeros(ceil(n / freqratio), 1);
+if uni
+  margin = 0;
+else
+  margin = filter_margin(plan, n);
+end
+z = {};
+for s = 1:blocksize:n
+  e = min(n, s + blocksize - 1);
+  S = max(1, s - margin);
+  E = min(n, e + margin);
+  [x, miss] = fill_nan(data, S, E, blocksize);
+  if uni
+    if s == 1
+      % run the padding through the filters to set their initial states
+      for ps = 1:blocksize:npad
+        [~, z] = uni_filter(plan, x(1) * ones(min(blocksize, npad - ps + 1), 1), z);
+      end
+    end
+    [x, z] = uni_filter(plan, x, z);
+  else
+    x = bi_filter(plan, x);
+    x = x((s - S + 1):(e - S + 1));
+    miss = miss((s - S + 1):(e - S + 1));
+  end
+  x(miss) = NaN;
+  % keep samples 1, 1 + freqratio, 1 + 2 * freqratio, ...
+  first = s + mod(freqratio - mod(s - 1, freqratio), freqratio);
+  idx = first:freqratio:e;
+  out((idx - 1) / freqratio + 1) = x(idx - s + 1);
+end
+
+function [x, miss] = fill_nan(data, s, e, blocksize)
+% linear interpolation of NaNs in data(s:e), and linear extrapolation
+% through the first or last two valid samples at the start or end of the
+% data, as pspm_interp1 does for the whole signal
+x = data(s:e);
+miss = isnan(x);
+if ~any(miss)
+  return
+end
+n = numel(data);
+% up to two valid samples before and after the block
+before = zeros(0, 1);
+p = s - 1;
+while numel(before) < 2 && p > 0
+  q = max(1, p - blocksize + 1);
+  before = [find(~isnan(data(q:p)), 2 - numel(before), 'last') + q - 1; before];
+  p = q - 1;
+end
+after = zeros(0, 1);
+p = e;
+while numel(after) < 2 && p < n
+  q = min(n, p + blocksize);
+  after = [after; find(~isnan(data(p + 1:q)), 2 - numel(after)) + p];
+  p = q;
+end
+knots = [before; find(~miss) + s - 1; after];
+if numel(knots) < 2
+  warning('ID:invalid_input', ...
+    'Input data contains less than 2 non-NaNs thus cannot be interpolated.');
+  return
+end
+x(miss) = interp1(knots, data(knots), find(miss) + s - 1, 'linear', 'extrap');
+
+function margin = filter_margin(plan, n)
+% number of samples after which the impulse response of all filters has
+% decayed below 1e-10, and at least the padding length of pspm_filtfilt
+r = 0;
+nfact = 0;
+for f = {plan.lp, plan.hp}
+  if isempty(f{1})
+    continue
+  end
+  if size(f{1}.b, 1) > 1
+    a = f{1}.b(:, 4:6);
+    nfact = max(nfact, 6 * size(a, 1));
+  else
+    a = f{1}.a;
+    nfact = max(nfact, 3 * (max(numel(f{1}.a), numel(f{1}.b)) - 1));
+  end
+  for k = 1:size(a, 1)
+    r = max([r; abs(roots(a(k, :)))]);
+  end
+end
+if r == 0
+  margin = 0;
+elseif r >= 1
+  margin = n;
+else
+  margin = min(n, max(nfact, ceil(log(1e-10) / log(r))));
+end
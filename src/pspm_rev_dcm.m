@@ -110,10 +110,8 @@ switch job
     ut(6, :) = 0; % eSCR onset at zero
     in.dt = 0.1;
     Theta = [dcm.sn{sn}.prior.theta 1];
-    for x = 1:size(ut, 2)
-      xt(x + 1, :) = f_SCR(xt(x, :), Theta, ut(:, x), in);
-    end;
-    figure; plot(xt(:, 1));
+    [~, xt] = pspm_dcm_integrate('f_SCR', xt, Theta, ut, in);
+    figure; plot(xt(1, :));
     set(gca, 'YTick', [], 'XTick', 0:50:300, 'XTickLabel', 0:5:30, 'FontWeight', 'Bold', 'FontSize', 12);
     set(get(gca, 'Title'), 'String', 'Skin conductance response function', 'FontWeight', 'Bold', 'FontSize', 16);
   case 'names'
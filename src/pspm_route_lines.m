@@ -0,0 +1,150 @@
+function [sts, out] = pspm_route_lines(str, routes, firstline)
+% ● Description
+%   pspm_route_lines is a shared tokenizer for delimited text files, used by
+%   the eyetracker importers. It indexes all lines of a text in one pass,
+%   routes each line to the first of a list of line classes whose tag
+%   matches the start of the line, and parses all lines of one class with
+%   a single textscan call.
+% ● Format
+%   [sts, out] = pspm_route_lines(str, routes)
+%   [sts, out] = pspm_route_lines(str, routes, firstline)
+% ● Arguments
+%   *        str : char row vector holding the complete file content.
+%   ┌─────routes : struct array with one element per line class
+%   ├───.pattern : regular expression that must match at the start of a
+%   │              line, e.g. '10\t' or '[^\t]*\tMSG\t'. An empty pattern
+%   │              matches all lines not claimed by a previous route.
+%   ├────.format : [optional] textscan format for the lines of this class.
+%   │              'auto' infers the format from the first line of the
+%   │              class: numeric fields (including '.' for missing
+%   │              values) are read as '%f', all other fields are skipped.
+%   │              Empty (default): the lines are returned as text.
+%   └───.options : [optional] cell array of name/value pairs passed on to
+%                  textscan, e.g. {'Delimiter', '\t', 'TreatAsEmpty', '.'}.
+%   *  firstline : [optional] lines before firstline are not routed.
+%                  Default: 1.
+% ● Output
+%   ┌────────out
+%   ├──.linebeg : index of the first character of each line in str.
+%   ├──.lineend : index of the last character of each line in str,
+%   │             excluding line terminators.
+%   └────.route : struct array with one element per route, with fields
+%                 lines (line numbers), data (textscan output, or cell
+%                 array of line strings if no format was given) and
+%                 format (the format used).
+% ● Developer's notes
+%   Line routing uses one regexp call per route over the whole text, and
+%   all lines of a route are gathered into one contiguous char array with
+%   a cumulative index instead of a loop over lines, so that the cost is
+%   linear in the file size.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+sts = -1;
+out = struct();
+if nargin < 2
+  warning('ID:invalid_input', 'Not enough input arguments.'); return;
+elseif ~ischar(str) || ~isstruct(routes) || ~isfield(routes, 'pattern')
+  warning('ID:invalid_input', 'Text must be a char array and routes a struct with field pattern.'); return;
+end
+if nargin < 3
+  firstline = 1;
+end
+str = str(:)';
+
+%% Index lines
+lf = find(str == sprintf('\n'));
+linebeg = [1, lf + 1];
+% the terminating newline of each line, or the last character for a final
+% line without newline
+lineterm = [lf, numel(str)];
+if linebeg(end) > numel(str)
+  % text ends with a newline: no further line
+  linebeg(end) = [];
+  lineterm(end) = [];
+end
+lineend = lineterm - (str(lineterm) == sprintf('\n'));
+has_cr = lineend >= linebeg & str(max(lineend, 1)) == sprintf('\r');
+lineend(has_cr) = lineend(has_cr) - 1;
+n_lines = numel(linebeg);
+
+%% Route lines
+assigned = zeros(1, n_lines);
+assigned(1:min(firstline - 1, n_lines)) = -1;
+route = struct('lines', {}, 'data', {}, 'format', {});
+for k = 1:numel(routes)
+  if isempty(routes(k).pattern)
+    lines = find(assigned == 0);
+  else
+    starts = regexp(str, ['^', routes(k).pattern], 'start', 'lineanchors');
+    [~, lines] = ismember(starts, linebeg);
+    lines = lines(lines > 0);
+    lines = lines(assigned(lines) == 0);
+  end
+  assigned(lines) = k;
+  route(k).lines = lines;
+end
+
+%% Parse lines of each route
+for k = 1:numel(routes)
+  lines = route(k).lines;
+  fmt = '';
+  if isfield(routes, 'format')
+    fmt = routes(k).format;
+  end
+  opts = {};
+  if isfield(routes, 'options') && ~isempty(routes(k).options)
+    opts = routes(k).options;
+  end
+  txt = gather_lines(str, linebeg(lines), lineterm(lines));
+  if isempty(fmt)
+    data = regexp(txt, '\r?\n', 'split');
+    if ~isempty(data) && isempty(data{end})
+      data(end) = [];
+    end
+    route(k).data = data;
+  else
+    if strcmpi(fmt, 'auto')
+      if isempty(lines)
+        fmt = '%f';
+      else
+        fmt = infer_format(str(linebeg(lines(1)):lineend(lines(1))), opts);
+      end
+    end
+    route(k).data = textscan(txt, fmt, opts{:});
+  end
+  route(k).format = fmt;
+end
+
+%% Sort outputs
+out.linebeg = linebeg;
+out.lineend = lineend;
+out.route = route;
+sts = 1;
+return
+
+function txt = gather_lines(str, b, t)
+% gather the character ranges b(i):t(i) into one char array
+if isempty(b)
+  txt = '';
+  return
+end
+len = t - b + 1;
+idx = ones(1, sum(len));
+idx(cumsum([1, len(1:end - 1)])) = [b(1), b(2:end) - t(1:end - 1)];
+txt = str(cumsum(idx));
+
+function fmt = infer_format(line, opts)
+% infer a textscan format from one line: numeric fields and '.' are read,
+% text fields are skipped
+delim = sprintf('\t');
+k = find(strcmpi(opts(1:2:end), 'Delimiter'), 1);
+if ~isempty(k)
+  delim = sprintf(opts{2 * k});
+end
+fields = strsplit(line, delim, 'CollapseDelimiters', false);
+is_num = ~isnan(str2double(fields)) | strcmp(strtrim(fields), '.') | cellfun(@isempty, strtrim(fields));
+fmt_fields = repmat({'%*s'}, 1, numel(fields));
+fmt_fields(is_num) = {'%f'};
+fmt = [fmt_fields{:}];
@@ -88,18 +88,9 @@ function [sts, out] = pspm_scr_pp(datafile, options)
 % ● Outputs
 %   *  channel_index: index of channel containing the processed data
 %   *  missing_epochs_file: file that contains the missing epochs
-% ● Internal Functions
-%   filter_to_epochs
-%                 Return the start and end points of epoches (2D array) by the
-%                 given filter (1D array).
-% ● Key Variables of Internal Functions
-%   filt          A filtering array consisting of 0 and 1 for selecting data
-%                 whose y and slope are both within the range of interest.
-%   filt_epochs   A filtering array consisting of 0 and 1 for selecting epochs.
-%   filt_range    A filtering array consisting of 0 and 1 for selecting data
-%                 within the range of interest.
-%   filt_slope    A filtering array consisting of 0 and 1 for selecting data
-%                 whose slope is within the range of interest.
+% ● Developer's notes
+%   The quality check is done by pspm_scr_qc, which can also be used on
+%   data in memory.
 % ● History
 %   Introduced In PsPM 5.1
 %   Written in 2017      by Tobias Moser (University of Zurich)
@@ -142,71 +133,12 @@ if ~any(size(indata) > 1)
     return;
 end
 
-%% Create filters
-% filt == 1 if sample is valid and filt == 0 if it is invalid
-data_changed = NaN(size(indata));
-filt_range = indata < options.max & indata > options.min;
-filt_slope = true(size(indata));
-filt_slope(2:end) = abs(diff(indata)*sr) < options.slope;
-if (options.deflection_threshold ~= 0) && ~all(filt_slope==1)
-    slope_epochs = pspm_logical2epochs(1-filt_slope); % sr = 1 
-    for r = transpose(slope_epochs)
-        if range(indata(r(1):r(2))) < options.deflection_threshold
-            filt_slope(r(1):r(2)) = 1;
-        end
-    end
-end
-[index_clipping, index_baseline] = detect_clipping_baseline(indata, options.clipping_step_size, ...
-    options.clipping_window_size, options.baseline_jump, options.clipping_threshold);
-if options.include_baseline
-    filt_clipping = 1 - (index_clipping | index_baseline);
-else
-    filt_clipping = 1-index_clipping;
-end
-% combine filters: 
-filt = filt_range & filt_slope;
-filt = filt & (1-filt_clipping);
-
-
-%% Find data islands and expand artefact islands
-if isempty(find(filt==0, 1))
-    warning('Epoch was empty based on the current settings.');
-else
-    if options.data_island_threshold > 0 || options.expand_epochs > 0
-        
-        % work out data epochs
-        missing_epochs = pspm_logical2epochs(1-filt,sr); % gives NaN (artefact) epochs
-        
-        if options.expand_epochs > 0
-            exp = options.expand_epochs;
-            [lsts, missing_epochs] = pspm_expand_epochs(missing_epochs, [exp,exp]);   
-            if lsts < 1, return, end
-        end
-        
-        missing_index = pspm_epochs2logical(missing_epochs,length(indata) ,sr);
-        data_epochs = pspm_logical2epochs(1-missing_index,sr);
-
-        % island threshold
-        if options.data_island_threshold > 0
-            epoch_duration = diff(data_epochs, 1, 2);
-            data_epochs(epoch_duration < options.data_island_threshold * sr, :) = [];
-        end
-
-        % write back into data
-        filt = pspm_epochs2logical(data_epochs, length(indata), sr); 
-        filt = logical(filt);
-
-    end
-
+%% Quality check
+[qsts, data_changed, epochs_missing] = pspm_scr_qc(indata, sr, options);
+if qsts < 1
+    return
 end
-data_changed(filt) = indata(filt);
 
-% Compute epochs missing
-if ~isempty(find(filt == 0, 1))
-    epochs_missing = pspm_logical2epochs(1-filt,sr);
-else
-    epochs_missing = [];
-end
 %% Save data
 if ~isempty(options.missing_epochs_filename)
     % Write epochs to mat if missing_epochs_filename option is present
@@ -232,37 +164,3 @@ end
 
 sts = 1; % sts is true if all processing above is successful
 return
-
-
-
-function [index_clipping, index_baseline] = detect_clipping_baseline(data, step_size, window_size, jump, threshold)
-l_data = length(data);
-n_window = floor((l_data-window_size) / step_size);
-index_window_starter = 1:step_size:(step_size*n_window+1);
-index_clipping = zeros(l_data,1);
-index_baseline = zeros(l_data,1);
-index_baseline_starter = [];
-index_baseline_end = [];
-for window_starter = index_window_starter
-    data_windowed = data(window_starter:(window_starter+window_size)-1);
-    data_windowed_max = max(data_windowed);
-    index_pred = (1:length(data_windowed))+window_starter-1;
-    if sum(data_windowed==data_windowed_max)/length(data_windowed) > threshold % detect clipping
-        index_clipping(index_pred) = 1;
-    end
-    if prctile(data_windowed, 1)>0 && (data_windowed_max / prctile(data_windowed, 1))>jump % detect baseline
-        if max(diff(data_windowed))>jump*prctile(data_windowed, 1) && ...
-                (min(diff(data_windowed))<jump*prctile(data_windowed, 1)*(-1))
-            target = find(diff(data_windowed)==max(diff(data_windowed)));
-            target = target(1);
-            index_baseline_starter(end+1) = index_pred(target+1);
-            target = find(diff(data_windowed)==min(diff(data_windowed)));
-            target = target(1);
-            index_baseline_end(end+1) = index_pred(target);
-        end
-    end
-end
-if ~isempty(index_baseline_starter)
-    C=cellfun(@(x,y)x:y,num2cell(index_baseline_starter),num2cell(index_baseline_end),'uni',false);
-    index_baseline([C{:}])=1;
-end
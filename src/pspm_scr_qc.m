@@ -0,0 +1,182 @@
+function [sts, data, missing_epochs] = pspm_scr_qc(data, sr, options)
+% ● Description
+%   pspm_scr_qc is the quality check engine of pspm_scr_pp. It checks skin
+%   conductance data for values out of range, steep slopes, clipping and
+%   baseline alterations, removes short data islands, and returns the
+%   cleaned data together with the missing epochs. It works on data in
+%   memory, such that many recordings can be checked without reading or
+%   writing PsPM files.
+% ● Format
+%   [sts, data, missing_epochs] = pspm_scr_qc(data, sr, options)
+% ● Arguments
+%   *           data : [numeric vector] skin conductance data.
+%   *             sr : [numeric] sampling rate in Hz.
+%   *        options : [struct] [optional] quality check settings as
+%                      described in pspm_scr_pp: .min, .max, .slope,
+%                      .deflection_threshold, .clipping_window_size,
+%                      .clipping_step_size, .clipping_threshold,
+%                      .baseline_jump, .include_baseline,
+%                      .data_island_threshold and .expand_epochs.
+% ● Output
+%   *           data : [numeric vector] data with missing samples set to NaN.
+%   * missing_epochs : [nx2 matrix] onsets and offsets of missing epochs in
+%                      seconds, empty if no data are missing.
+% ● Developer's notes
+%   Clipping and baseline alterations are checked in windows of
+%   .clipping_window_size samples every .clipping_step_size samples. The
+%   window maxima and minima are computed for all windows at once with
+%   moving statistics, and the number of samples equal to the window
+%   maximum by a binary search in the data sorted by value and sample
+%   index. The 1st percentile needed for baseline detection is only
+%   computed in the few windows that pass the necessary conditions on the
+%   window minimum. Missing epochs are handled as interval lists by
+%   pspm_intervals.
+% ● History
+%   Introduced in PsPM 7.1
+
+%% Initialise
+global settings
+if isempty(settings)
+  pspm_init;
+end
+sts = -1;
+missing_epochs = [];
+if nargin < 2
+  warning('ID:invalid_input', 'Not enough input arguments.'); return;
+elseif nargin < 3
+  options = struct();
+end
+options = pspm_options(options, 'scr_pp');
+if options.invalid
+  return
+end
+if ~isnumeric(data) || ~isvector(data) || numel(data) < 2
+  warning('ID:invalid_input', 'Argument ''data'' should contain > 1 data points.'); return;
+elseif ~isnumeric(sr) || ~isscalar(sr) || sr <= 0
+  warning('ID:invalid_input', 'Sampling rate must be a positive number.'); return;
+end
+x = data(:);
+n = numel(x);
+
+%% Create filters
+% filt is true for valid samples
+filt_range = x < options.max & x > options.min;
+filt_slope = [true; abs(diff(x) * sr) < options.slope];
+if options.deflection_threshold ~= 0 && ~all(filt_slope)
+  filt_slope = keep_small_deflections(x, filt_slope, options.deflection_threshold);
+end
+[index_clipping, index_baseline] = detect_clipping_baseline(x, options.clipping_step_size, ...
+  options.clipping_window_size, options.baseline_jump, options.clipping_threshold);
+if options.include_baseline
+  index_clipping = index_clipping | index_baseline;
+end
+filt = filt_range & filt_slope & ~index_clipping;
+
+%% Find data islands and expand artefact islands
+% missing epochs are kept as a list of sample intervals, such that
+% expansion and island removal do not need further passes over the data
+missing = pspm_intervals('from_logical', ~filt);
+if isempty(missing)
+  warning('Epoch was empty based on the current settings.');
+elseif options.data_island_threshold > 0 || options.expand_epochs > 0
+  if options.expand_epochs > 0
+    expansion = round(options.expand_epochs * sr);
+    missing = pspm_intervals('clip', ...
+      pspm_intervals('expand', missing, [expansion, expansion]), [1, n + 1]);
+  end
+  data_epochs = pspm_intervals('complement', missing, [1, n + 1]);
+  if options.data_island_threshold > 0
+    epoch_duration = diff(data_epochs, 1, 2);
+    data_epochs(epoch_duration < options.data_island_threshold * sr, :) = [];
+  end
+  missing = pspm_intervals('complement', data_epochs, [1, n + 1]);
+  filt = pspm_intervals('to_logical', data_epochs, n);
+end
+
+%% Write output
+data(~filt) = NaN;
+if ~isempty(missing)
+  missing_epochs = (missing - 1) / sr;
+end
+sts = 1;
+return
+
+function filt_slope = keep_small_deflections(x, filt_slope, threshold)
+% steep slopes are accepted if the data in the slope epoch, including the
+% first sample after it, vary by less than threshold
+epochs = pspm_intervals('from_logical', ~filt_slope);
+n = numel(x);
+epochs(:, 2) = min(epochs(:, 2) + 1, n + 1);
+% label the samples of each epoch, which are disjoint
+label = zeros(n, 1);
+inside = pspm_intervals('to_logical', epochs, n);
+label(epochs(:, 1)) = 1;
+label = cumsum(label);
+k = size(epochs, 1);
+deflection = accumarray(label(inside), x(inside), [k, 1], @max) - ...
+  accumarray(label(inside), x(inside), [k, 1], @min);
+filt_slope = filt_slope | ...
+  pspm_intervals('to_logical', epochs(deflection < threshold, :), n);
+return
+
+function [index_clipping, index_baseline] = detect_clipping_baseline(data, step_size, window_size, jump, threshold)
+l_data = length(data);
+n_window = floor((l_data - window_size) / step_size);
+index_window_starter = (1:step_size:(step_size * n_window + 1))';
+index_clipping = false(l_data, 1);
+index_baseline = false(l_data, 1);
+if isempty(index_window_starter)
+  return
+end
+index_window_end = index_window_starter + window_size - 1;
+window_max = movmax(data, [0, window_size - 1], 'omitnan');
+window_max = window_max(index_window_starter);
+% clipping: the proportion of samples equal to the window maximum exceeds
+% threshold. Samples are ranked by value (NaN get rank 0), and counted in
+% the window by their position in the list sorted by rank and index.
+[~, ~, value_rank] = unique(data);
+value_rank(isnan(data)) = 0;
+max_rank = movmax(value_rank, [0, window_size - 1]);
+max_rank = max_rank(index_window_starter);
+key = sort(value_rank * (l_data + 1) + (1:l_data)');
+n_max = pspm_bsearch(key, max_rank * (l_data + 1) + index_window_end, 'floor') - ...
+  pspm_bsearch(key, max_rank * (l_data + 1) + index_window_starter - 1, 'floor');
+n_max(max_rank == 0) = 0;
+is_clipping = n_max / window_size > threshold;
+index_clipping = pspm_intervals('to_logical', ...
+  [index_window_starter(is_clipping), index_window_end(is_clipping) + 1], l_data);
+% baseline alteration: a jump up and down by more than jump times the 1st
+% percentile of the window. As the percentile is at least the window
+% minimum, only windows that pass this test with the minimum are checked.
+if window_size < 2
+  return
+end
+floor_min = max(movmin(data, [0, window_size - 1], 'omitnan'), 0);
+floor_min = floor_min(index_window_starter);
+d = diff(data);
+diff_max = movmax(d, [0, window_size - 2], 'omitnan');
+diff_min = movmin(d, [0, window_size - 2], 'omitnan');
+candidate = find(window_max > 0 & window_max > jump * floor_min & ...
+  diff_max(index_window_starter) > jump * floor_min & ...
+  diff_min(index_window_starter) < -jump * floor_min);
+index_baseline_starter = [];
+index_baseline_end = [];
+for window_starter = index_window_starter(candidate)'
+  data_windowed = data(window_starter:(window_starter + window_size - 1));
+  data_windowed_max = max(data_windowed);
+  data_windowed_p1 = prctile(data_windowed, 1);
+  data_windowed_diff = diff(data_windowed);
+  if data_windowed_p1 > 0 && (data_windowed_max / data_windowed_p1) > jump && ...
+      max(data_windowed_diff) > jump * data_windowed_p1 && ...
+      min(data_windowed_diff) < jump * data_windowed_p1 * (-1)
+    [~, target] = max(data_windowed_diff);
+    index_baseline_starter(end + 1, 1) = window_starter + target;
+    [~, target] = min(data_windowed_diff);
+    index_baseline_end(end + 1, 1) = window_starter + target - 1;
+  end
+end
+if ~isempty(index_baseline_starter)
+  index_baseline = pspm_intervals('to_logical', ...
+    [index_baseline_starter, index_baseline_end + 1], l_data);
+end
+return
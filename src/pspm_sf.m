@@ -61,9 +61,12 @@ function [sts, sf] = pspm_sf(model, options)
 %   │                   Display progress plot (DCM) or result plot (MP).
 %   ├──.dispsmallwin :  [logical, default: 0]
 %   │                   Display intermediate progress windows. (Used for DCM only.)
-%   └─.missingthresh :  [numeric, default: 2] [unit: second]
-%                       Threshold value for controlling missing epochs.
-%                       (Used for DCM only).
+%   ├─.missingthresh :  [numeric, default: 2] [unit: second]
+%   │                   Threshold value for controlling missing epochs.
+%   │                   (Used for DCM only).
+%   └────.vb_backend :  ['vba'/'pspm', default: 'vba']
+%                       Gauss-Newton update of the VB inversion, see
+%                       pspm_sf_dcm. (Used for DCM only.)
 %
 % ● References
 %   [1] DCM for SF:
@@ -21,8 +21,13 @@ function [sts, out] = pspm_sf_dcm(model, options)
 %   ├───────.fresp : [numeric] [unit: Hz] [default: 0.5] frequency of responses to model
 %   ├─────.dispwin : [logical] [default: 1] display progress window.
 %   ├.dispsmallwin : [logical] [default: 0] display intermediate windows.
-%   └.missingthresh: [numeric] [default: 2] [unit: second] threshold value for controlling
-%                    missing epochs, which is originally inherited from SF.
+%   ├.missingthresh: [numeric] [default: 2] [unit: second] threshold value for controlling
+%   │                missing epochs, which is originally inherited from SF.
+%   └──.vb_backend : ['vba'/'pspm'] [default: 'vba'] Gauss-Newton update of
+%                    the VB inversion. 'pspm' uses pspm_dcm_iphi, which
+%                    integrates f_SF and its sensitivities in one call
+%                    instead of one time step at a time, with the same
+%                    results.
 % ● References
 %   Bach DR, Daunizeau J, Kuelzow N, Friston KJ, & Dolan RJ (2011). Dynamic
 %   causal modelling of spontaneous fluctuations in skin conductance.
@@ -99,6 +104,9 @@ for k = 1:numel(model.scr)  % default priors on noise covariance
 end
 options.inG.ind = 1;
 options.inF.dt = 1/model.sr;
+if strcmp(options.vb_backend, 'pspm')
+  options.Iphi_fname = @pspm_dcm_iphi;
+end
 % 4.3 prepare data
 y = model.scr;
 y = y - min(y);
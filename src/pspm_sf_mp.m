@@ -31,12 +31,23 @@ function [sts, out] = pspm_sf_mp(model, options)
 %   ├─.threshold : threshold applied for response detection
 %   ├───.yhat : fitted time series (using reestimated amplitudes)
 %   ├.yhatraw : fitted time series (using initial amplitudes)
-%   ├──────.ind : indices of selected dictionary atoms in D.D
+%   ├──────.ind : indices of selected dictionary atoms
 %   ├──.sortind : sorted indices of selected atoms (after pruning)
 %   ├───────.y : preprocessed input data (baseline-centered scr)
 %   ├───.time : total execution time in seconds
 %   ├──────.S : inversion settings (struct with algorithm parameters)
-%   └──────.D : inversion dictionary (struct with atoms and metadata)
+%   └──────.D : inversion dictionary (struct with atoms and metadata), only
+%               with options.diagnostics
+% ● Developer's notes
+%   The dictionary consists of the SF template shifted to every sample of
+%   the data segment and of the preceding SF tail. It is not stored as a
+%   matrix, which would take memory quadratic in the number of samples;
+%   atoms are defined by their onset and norm only. Inner products of all
+%   atoms with the data are computed once by FFT cross-correlation, and
+%   after each selected atom is subtracted from the residual, only the
+%   inner products of the atoms that overlap with it are updated. The
+%   largest inner product is tracked per block of atoms. The dictionary
+%   matrix D.D is only written to the output with options.diagnostics.
 % ● References
 %   [1] Bach DR, Staib M (2015). A matching pursuit algorithm for inferring tonic
 %       sympathetic arousal from spontaneous skin conductance fluctuations.
@@ -98,67 +109,40 @@ S.maxres = 0.001 * S.n;         % residual threshold per sample
 S.options = options;
 S.threshold = options.threshold;
 
-% generate over-complete dictionary D.D
+% generate SF template
 % -------------------------------------------------------------------------
-
-% generate SF templates ---
 for iSet = 1:numel(S.sfsets)
   % generate each set of predefined SF by calling ODE
-  Xt = zeros(3, 1);
   ut = S.dt:S.dt:S.sfduration;
   ut(2, :) = numel(S.sfsets{iSet})/2;
   in.dt = S.dt;
   Theta = [S.theta(1:3), S.sfsets{iSet}];
-  for k = 1:(size(ut, 2) - 1)
-    Xt(:, k + 1) = f_SF(Xt(:, k), Theta, ut(:, k), in);
-  end;
+  [~, Xt] = pspm_dcm_integrate('f_SF', zeros(3, 1), Theta, ut(:, 1:(end - 1)), in);
   % extract SF amplitude and normalise to 1 unit
   if iSet == 1
     sfa = max(Xt(1, :));
   end;
   sf{iSet} = Xt(1, :)/sfa;
 end;
+sf = sf{1};
+nsf = numel(sf);
 
-% initialise D.D ---
-D.D = zeros(numel(S.sfsets) * S.n + S.ntail + numel(S.tonicsets{1}) * numel(S.tonicsets{2}), S.n);
-
-% model atoms for SF tail ---
-for k = 1:S.ntail
-  D.D(k, 1:min(S.n, S.nsf - S.ntail + k - 1)) = sf{1}((S.ntail - k + 2):min(S.nsf, S.ntail - k + 1 + S.n));
-  D.tindx(k) = 1 - (S.ntail - k + 1) .* S.dt;
-end;
-Dindx = k;
-
-% model atoms for SF occuring in data segment --
-for iSet = 1:numel(S.sfsets)
-  maxn = S.n;
-  for k = 1:maxn
-    D.D(Dindx + k, k:min(k + S.nsf - 1, S.n)) = sf{iSet}(1:min(S.nsf, S.n - k + 1));
-    D.tindx(Dindx + k) = 1 + (k - 1) .* S.dt;
-  end;
-  Dindx = Dindx + k;
-end;
-D.phasicterms = Dindx;
-
-Dindx = Dindx + 1;
-
-% model tonic atoms
-for ia = 1:numel(S.tonicsets{1})
-  for ib = 1:numel(S.tonicsets{2})
-    D.D(Dindx, :) = S.tonicsets{1}(ia) + (1:S.n) * S.dt * S.tonicsets{2}(ib);
-    D.D(Dindx + 1, :) = (S.tonicsets{1}(ia) + S.n * S.dt * S.tonicsets{2}(ib)) - (1:S.n) * S.dt * S.tonicsets{2}(ib);
-    D.tindx(Dindx + (0:1)) = NaN;
-    Dindx = Dindx + 2;
-  end;
-end;
-
-% % normalise D.D and retain original amplitudes --
-% (this is to make inner product interpretable)
-D.aD = sqrt(diag(D.D*D.D'));
-D.D = D.D./repmat(D.aD, 1, size(D.D, 2));
+% implicit dictionary D
+% -------------------------------------------------------------------------
+% atom i is the SF template with onset at sample i - ntail, truncated to
+% the data segment; the first ntail atoms model the tails of SF that
+% started before the data segment
+ntail = floor(S.ntail);
+natoms = ntail + S.n;
+onset = (1:natoms) - ntail;
+D.tindx = 1 + (onset - 1) .* S.dt;
+D.phasicterms = natoms;
+% norm of the truncated atoms, to make inner products interpretable
+sf2 = [0, cumsum(sf.^2)];
+D.aD = sqrt(sf2(min(nsf, S.n - onset + 1) + 1) - sf2(max(1, 2 - onset)))';
 
 % clear local variables ---
-clear Xt ut in Theta k iSet sfa maxsn D.Dindx
+clear Xt ut in Theta iSet sfa sf2
 
 % prepare data
 % -------------------------------------------------------------------------
@@ -181,17 +165,28 @@ a = [];
 asf = [];
 ind = [];
 
+% inner products of all atoms with the residual, by FFT cross-correlation
+% of the data with the template; atom i is at lag i - ntail + nsf - 1
+nfft = 2^nextpow2(S.n + nsf - 1);
+xc = real(ifft(fft(y, nfft) .* fft(flipud(sf(:)), nfft)));
+xc = xc(onset + nsf - 1);
+anew = xc ./ D.aD;
+anew(D.aD == 0) = NaN;
+% used atoms are excluded from the search; the maximum is kept per block
+% of nsf atoms, such that only the blocks around the last atom are
+% searched again in each iteration
+used = false(natoms, 1);
+nblock = ceil(natoms / nsf);
+blockmax = NaN(1, nblock);
+blockind = ones(1, nblock);
+[blockmax, blockind] = update_blocks(blockmax, blockind, anew, used, 1:nblock, nsf);
+sres = sum(S.Yres.^2);
+
 % run algorithm ---
 while S.cont
-  % remove used atoms from dictionary
-  S.Dind = find(~ismember(1:(size(D.D, 1)), ind));
-  S.Dtemp = D.D(S.Dind, :);
-  % compute inner product
-  anew = S.Dtemp * S.Yres;
   % search for largest value and retain index
-  [a(k, 1), tempindx] = max(anew);
-  % translate temporary index into index for entire dictionary
-  ind(k, 1) = S.Dind(tempindx);
+  [a(k, 1), b] = max(blockmax);
+  ind(k, 1) = (b - 1) * nsf + blockind(b);
   % stopping criterion: negative and zero values
   if a(k, 1) <=0
     a(k) = []; ind(k) = [];
@@ -200,10 +195,25 @@ while S.cont
   else
     % compute amplitude in original values
     asf(k, 1) = a(k)/D.aD(ind(k));
-    % compute residual
-    S.Yres = S.Yres - a(k) * D.D(ind(k), :)';
+    % compute residual, on the support of the atom
+    j = max(1, onset(ind(k))):min(S.n, onset(ind(k)) + nsf - 1);
+    delta = -a(k) * sf(j - onset(ind(k)) + 1)' / D.aD(ind(k));
+    sres = sres - sum(S.Yres(j).^2);
+    S.Yres(j) = S.Yres(j) + delta;
+    sres = sres + sum(S.Yres(j).^2);
+    % update inner products of overlapping atoms
+    dxc = conv(delta, flipud(sf(:)));
+    i = (1:numel(dxc))' + j(1) - nsf + ntail;
+    dxc = dxc(i >= 1 & i <= natoms);
+    i = i(i >= 1 & i <= natoms);
+    xc(i) = xc(i) + dxc;
+    anew(i) = xc(i) ./ D.aD(i);
+    anew(i(D.aD(i) == 0)) = NaN;
+    used(ind(k)) = true;
+    [blockmax, blockind] = update_blocks(blockmax, blockind, anew, used, ...
+      unique(ceil([i(:); ind(k)] / nsf))', nsf);
     % stopping criteria: smaller than threshold, maximum number of sf
-    if sum(S.Yres.^2) < S.maxres || k >= S.maxsf
+    if sres < S.maxres || k >= S.maxsf
       S.cont = 0;
     end;
     k = k + 1;
@@ -213,19 +223,23 @@ end;
 S.diagnostics.num = numel(a); % number of iterations
 S.diagnostics.error = sum(S.Yres.^2); % error
 
-% reestimate all amplitudes simultaneously using ML as engendered in pinv
+% reestimate all amplitudes simultaneously using ML
 % -------------------------------------------------------------------------
-aprime = pinv(D.D(ind, :))' * y;
+% least squares solution for the selected, normalised atoms, via the
+% Cholesky factor of their Gram matrix unless this is ill-conditioned
+Dsel = atoms(onset(ind), sf, S.n) * spdiags(1 ./ D.aD(ind), 0, numel(ind), numel(ind));
+[R, p] = chol(full(Dsel' * Dsel));
+if p == 0 && (isempty(R) || rcond(R) > S.n * eps)
+  aprime = R \ (R' \ (Dsel' * y));
+else
+  aprime = pinv(full(Dsel)) * y;
+end
 asfprime = aprime./D.aD(ind);
 
 % reconstruct responses
 % -------------------------------------------------------------------------
-Yhat = sum(repmat(a, 1, size(D.D, 2)) .* D.D(ind, :), 1);
-Yhatprime = sum(repmat(aprime, 1, size(D.D, 2)) .* D.D(ind, :), 1);
-
-% revert normalisation of dictionary
-% -------------------------------------------------------------------------
-D.D = D.D .* repmat(D.aD, 1, size(D.D, 2));
+Yhat = full(Dsel * a(:))';
+Yhatprime = full(Dsel * aprime(:))';
 
 % extract timing and amplitudes
 % -------------------------------------------------------------------------
@@ -240,12 +254,12 @@ out.n = numel(find(out.a > S.threshold));
 out.f = out.n/(numel(scr)/sr);
 out.ma = mean(out.a(out.a > S.threshold));
 
-% cleanup S.Dtemp
-S = rmfield(S, 'Dtemp');
 out.S = S;
 
-% only add field D if options.diagnostics is set to true.
+% only add field D if options.diagnostics is set to true; the atoms are
+% only written out as matrix D.D in this case
 if options.diagnostics
+  D.D = full(atoms(onset, sf, S.n))';
   out.D = D;
 end;
 out.ind = ind;
@@ -263,6 +277,32 @@ if options.dispwin
   ind = ind(out.a > S.threshold);
   plot(Yhatprime, 'g'); hold on
   plot(y, 'k');
-  plot(D.D(ind, :)', 'b');
+  plot(full(atoms(onset(ind), sf, S.n)), 'b');
   plot(Yhat, 'r');
 end;
+sts = 1;
+return
+
+function A = atoms(onset, sf, n)
+% sparse n x numel(onset) matrix of SF templates with the given onsets in
+% samples, truncated to the data segment
+nsf = numel(sf);
+j = bsxfun(@plus, (0:(nsf - 1))', onset(:)');
+m = repmat((1:nsf)', 1, numel(onset));
+col = repmat(1:numel(onset), nsf, 1);
+valid = j >= 1 & j <= n;
+sf = sf(:);
+A = sparse(j(valid), col(valid), sf(m(valid)), n, numel(onset));
+return
+
+function [blockmax, blockind] = update_blocks(blockmax, blockind, anew, used, blocks, blocksize)
+% maximum inner product of unused atoms and its index within each block of
+% blocksize atoms
+natoms = numel(anew);
+for b = blocks
+  i = ((b - 1) * blocksize + 1):min(b * blocksize, natoms);
+  v = anew(i);
+  v(used(i)) = -Inf;
+  [blockmax(b), blockind(b)] = max(v);
+end
+return
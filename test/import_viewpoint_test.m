@@ -93,6 +93,56 @@ classdef import_viewpoint_test < matlab.unittest.TestCase
         this.test_import_viewpoint_on_file(f{1});
       end
     end
+    function test_import_viewpoint_synthetic(this)
+      % two sessions of 5 samples at 100 Hz, with a marker message, a blink
+      % and a saccade, and Windows line endings
+      fn = [tempname, '.txt'];
+      t = (0:9)' / 100;
+      mrk = {'+'; 'a'; 'b'; 'c'; 'd'; '+'; 'e'; 'f'; 'g'; 'h'};
+      lines = {sprintf('3\tTimeStamp\tMonday, January 6, 2020, 10:11:12 AM'), ...
+        sprintf('3\tScreenSize\t400\t300'), ...
+        sprintf('3\tViewingDistance\t600'), ...
+        sprintf('5\tTotalTime\tDeltaTime\tX_Gaze\tY_Gaze\tPupilWidth\tMarker'), ...
+        sprintf('6\tATT\tADT\tALX\tALY\tAPW\tMRK')};
+      for k = 1:10
+        lines{end + 1} = sprintf('10\t%.4f\t10.0\t%.3f\t%.3f\t%.3f\t%s', ...
+          t(k), k / 20, 1 - k / 20, 0.1 + k / 100, mrk{k});
+        if k == 3
+          lines{end + 1} = sprintf('2\t%.4f\tcue', t(k));
+        elseif k == 5
+          lines{end + 1} = sprintf('16\t%.4f\tA:Blink for 0.0200 sec', t(k));
+        elseif k == 9
+          lines{end + 1} = sprintf('16\t%.4f\tA:Saccade for 0.0100 sec', t(k));
+        end
+      end
+      fid = fopen(fn, 'w');
+      fprintf(fid, '%s\r\n', lines{:});
+      fclose(fid);
+      addpath(this.funcpath);
+      data = import_viewpoint(fn);
+      rmpath(this.funcpath);
+      delete(fn);
+      this.verifyEqual(numel(data), 2);
+      this.verifyEqual(data{1}.record_date, '06.01.2020');
+      this.verifyEqual(data{1}.record_time, '10:11:12');
+      this.verifyEqual(data{1}.viewingDistance, 600);
+      this.verifyEqual(data{1}.screenSize.xmax, 400);
+      this.verifyEqual(data{1}.screenSize.ymax, 300);
+      this.verifyEqual(data{1}.eyesObserved, 'A');
+      this.verifyEqual(data{1}.dataraw_header, {'ATT', 'ADT', 'ALX', 'ALY', 'APW'});
+      this.verifyEqual(data{1}.dataraw(:, 1), t(1:5), 'AbsTol', 1e-10);
+      this.verifyEqual(data{2}.dataraw(:, 3), (6:10)' / 20, 'AbsTol', 1e-10);
+      % the marker message replaces the marker column of its sample
+      this.verifyEqual(data{1}.marker.name, {'+'; 'a'; 'cue'; 'c'; 'd'});
+      this.verifyEqual(data{2}.marker.times, t(6:10), 'AbsTol', 1e-10);
+      % blink and saccade epochs, reported at their end
+      header = data{1}.channel_header;
+      this.verifyEqual(header, {'Time'; 'pupil_A'; 'gaze_x_A'; 'gaze_y_A'; 'blink_A'; 'saccade_A'});
+      this.verifyEqual(data{1}.channels(:, 5), [0; 0; 1; 1; 1]);
+      this.verifyEqual(data{1}.channels(:, 6), zeros(5, 1));
+      this.verifyEqual(data{2}.channels(:, 6), [0; 0; 1; 1; 0]);
+      this.verifyEqual(data{2}.channels(:, 2), 0.1 + (6:10)' / 100, 'AbsTol', 1e-10);
+    end
   end
 end
 function mat = get_manual_matrix(datalines, header, cols_to_get)
@@ -0,0 +1,55 @@
+classdef pspm_bsearch_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_bsearch function
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_bsearch(1:3), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_bsearch([], 1), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_bsearch(1:3, 1, 'round'), 'ID:invalid_input');
+    end
+    function modes(this)
+      x = [1, 2, 4, 8];
+      q = [0; 1; 2.9; 3; 3.1; 8; 9; NaN];
+      this.verifyEqual(pspm_bsearch(x, q), [1; 1; 2; 2; 3; 4; 4; NaN]);
+      this.verifyEqual(pspm_bsearch(x, q, 'floor'), [0; 1; 2; 2; 2; 4; 4; NaN]);
+      this.verifyEqual(pspm_bsearch(x, q, 'ceil'), [1; 1; 3; 3; 3; 4; 5; NaN]);
+      % the output takes the shape of the queries
+      this.verifyEqual(pspm_bsearch(x', q'), pspm_bsearch(x, q)');
+    end
+    function descending(this)
+      x = [8, 4, 2, 1];
+      q = [0, 2.9, 3.1, 9];
+      this.verifyEqual(pspm_bsearch(x, q), [4, 3, 2, 1]);
+      this.verifyEqual(pspm_bsearch(x, q, 'floor'), [5, 3, 3, 1]);
+      this.verifyEqual(pspm_bsearch(x, q, 'ceil'), [4, 2, 2, 0]);
+    end
+    function unsorted_queries(this)
+      x = cumsum(rand(1000, 1));
+      q = x(end) * rand(5000, 1);
+      [~, expected] = min(abs(bsxfun(@minus, x', q)), [], 2);
+      this.verifyEqual(pspm_bsearch(x, q), expected);
+      this.verifyEqual(pspm_bsearch(x, q, 'floor'), sum(bsxfun(@le, x', q), 2));
+    end
+    function few_queries(this)
+      % few queries are located by binary search, with the same results as
+      % the merge of many queries, also for repeated grid values
+      x = [1; 2; 2; 2; 3];
+      this.verifyEqual(pspm_bsearch(x, 2, 'floor'), 4);
+      this.verifyEqual(pspm_bsearch(x, 2, 'ceil'), 2);
+      this.verifyEqual(pspm_bsearch(x, 2), 4);
+      this.verifyEqual(pspm_bsearch(x, repmat(2, 1, 20), 'ceil'), repmat(2, 1, 20));
+      x = cumsum(round(2 * rand(10000, 1)));
+      q = [x(end) * rand(3, 1); x(1) - 1; x(end) + 1; x(5000); NaN];
+      many = [q; x(end) * rand(20000, 1)];
+      modes = {'nearest', 'floor', 'ceil'};
+      for m = 1:numel(modes)
+        expected = pspm_bsearch(x, many, modes{m});
+        this.verifyEqual(pspm_bsearch(x, q, modes{m}), expected(1:numel(q)));
+        for k = 1:numel(q)
+          this.verifyEqual(pspm_bsearch(x, q(k), modes{m}), expected(k));
+        end
+      end
+      this.verifyEqual(pspm_bsearch(x, q(1:5), 'floor'), sum(bsxfun(@le, x', q(1:5)), 2));
+    end
+  end
+end
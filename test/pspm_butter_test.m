@@ -16,6 +16,33 @@ classdef pspm_butter_test < matlab.unittest.TestCase
       this.verifyWarning(@() pspm_butter(2,1), 'ID:toolbox_missing');
       % Verify that Signal processing toolbox is missing #2
       this.verifyWarning(@() pspm_butter(1,1), 'ID:toolbox_missing');
+      % Verify that the form is either 'tf' or 'sos'
+      this.verifyWarning(@() pspm_butter(1,0.5,'low','abc'), 'ID:invalid_input');
+      % Verify that second-order sections need a valid frequency ratio
+      this.verifyWarning(@() pspm_butter(2,1,'low','sos'), 'ID:invalid_input');
+    end
+    function second_order_sections(this)
+      % Verify that sections are designed without the toolbox
+      global settings;
+      if isempty(settings), pspm_init; end;
+      settings.signal = 0;
+      [sts, sos, g] = pspm_butter(1, 0.5, 'low', 'sos');
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(g, 1);
+      this.verifyEqual(sos, [0.5 0.5 0 1 0 0], 'AbsTol', 1e-12);
+      for order = 2:7
+        [~, sos] = pspm_butter(order, 0.01, 'low', 'sos');
+        this.verifySize(sos, [ceil(order/2), 6]);
+        % unit gain at DC, zero gain at Nyquist
+        this.verifyEqual(prod(sum(sos(:,1:3),2) ./ sum(sos(:,4:6),2)), 1, 'AbsTol', 1e-10);
+        this.verifyEqual(prod(sos(:,1) - sos(:,2) + sos(:,3)), 0, 'AbsTol', 1e-10);
+        % -3 dB at the cut-off frequency
+        z = exp(1i * pi * 0.01);
+        h = prod((sos(:,1) + sos(:,2)/z + sos(:,3)/z^2) ./ (sos(:,4) + sos(:,5)/z + sos(:,6)/z^2));
+        this.verifyEqual(abs(h), sqrt(0.5), 'AbsTol', 1e-8);
+        [~, sos] = pspm_butter(order, 0.01, 'high', 'sos');
+        this.verifyEqual(prod(sum(sos(:,1:3),2)), 0, 'AbsTol', 1e-10);
+      end
     end
   end
 end
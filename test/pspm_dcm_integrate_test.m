@@ -0,0 +1,83 @@
+classdef pspm_dcm_integrate_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_dcm_integrate function
+  properties
+    % one aSCR, eSCR, SF and SCL change each
+    ut = [2.3; 1; 1; 1; 1; 0.5; 2; 1; 1; 2; 4; 1.5; 3.5];
+    Theta = [log([0.12, 1.4, 1.3, 1.5]), 0.5, 0.6, 0.7, 0.2, -0.3, 0.1, 0.3, 0.1, 0.2, -0.2, 0.8]';
+    in = struct('dt', 0.01);
+    % reference trajectory for ut and Theta, see trajectory
+    Xref = [
+        0.000248313655713278, 0.0128615322127203, 0.266645344062728, 1.13844859317635, 1.96875296449348;
+        0.00123567158720022, 0.0440805529100315, 0.603020498178356, 0.994600683088362, 0.563396543577347;
+        0.00541145443753271, 0.146944335553263, 0.791840871370081, -0.0776988183460268, -0.653925624211318;
+        8.20260954947033e-15, 1.26444045352126e-06, 0.0148547734149306, 0.338966995108262, 0.90982407934682;
+        2.2219040071361e-13, 1.86764526296854e-05, 0.0827013916425807, 0.546580600499559, 0.490930546003995;
+        5.87905891605177e-12, 0.000259787347791009, 0.354739860036791, 0.263893012312557, -0.352185465246598;
+        0.131520706635418, 0.636277303104321, 1.4034474166659, 1.86810191177539, 1.97982336692328];
+  end
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_dcm_integrate('f_SCR', zeros(7, 1), this.Theta), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_dcm_integrate('f_XYZ', zeros(7, 1), this.Theta, this.ut), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_dcm_integrate('f_SCR', zeros(3, 1), this.Theta, this.ut), 'ID:invalid_input');
+    end
+    function trajectory(this)
+      % the trajectory equals the one of the per-step Euler implementation
+      % of f_SCR in PsPM 7.0, at samples 101, 201, ..., 501
+      ut = repmat(this.ut, 1, 500);
+      ut(1, :) = (0:499) * this.in.dt;
+      ut(2:end, 1) = 0;
+      [sts, Xt] = pspm_dcm_integrate('f_SCR', zeros(7, 1), this.Theta, ut, this.in);
+      this.verifyEqual(sts, 1);
+      this.verifySize(Xt, [7, 501]);
+      this.verifyEqual(Xt(:, 101:100:501), this.Xref, 'AbsTol', 1e-12);
+      % f_SCR steps along the same trajectory
+      this.verifyEqual(f_SCR(Xt(:, 300), this.Theta, ut(:, 300), this.in), Xt(:, 301), 'AbsTol', 1e-14);
+    end
+    function empty_input(this)
+      % without time steps, the trajectory is the initial state
+      X0 = (1:7)' / 10;
+      [sts, Xt, dfdx, dfdP] = pspm_dcm_integrate('f_SCR', X0, this.Theta, zeros(size(this.ut, 1), 0), this.in);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(Xt, X0);
+      this.verifySize(dfdx, [7, 7]);
+      this.verifyEmpty(dfdP);
+      [sts, Xt] = pspm_dcm_integrate('f_SF', [0.1; 0; 0], pspm_sf_theta, zeros(2, 0));
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(Xt, [0.1; 0; 0]);
+    end
+    function jacobians_scr(this)
+      X = (1:7)' / 10;
+      [~, ~, dfdx, dfdP] = pspm_dcm_integrate('f_SCR', X, this.Theta, this.ut, this.in);
+      f = @(th) pspm_dcm_integrate_test.step('f_SCR', X, th, this.ut, this.in);
+      this.verifyEqual(dfdP, pspm_dcm_integrate_test.numeric_jacobian(f, this.Theta), 'AbsTol', 1e-8);
+      fx = @(x) pspm_dcm_integrate_test.step('f_SCR', x, this.Theta, this.ut, this.in);
+      this.verifyEqual(dfdx, pspm_dcm_integrate_test.numeric_jacobian(fx, X), 'AbsTol', 1e-8);
+    end
+    function jacobians_sf(this)
+      X = [0.1; 0.2; 0.3];
+      Theta = [0.5, 1.2, 0.9, 1, 0.2, 2, -0.4]';
+      ut = [1.6; 2];
+      [~, ~, ~, dfdP] = pspm_dcm_integrate('f_SF', X, Theta, ut, this.in);
+      f = @(th) pspm_dcm_integrate_test.step('f_SF', X, th, ut, this.in);
+      this.verifyEqual(dfdP, pspm_dcm_integrate_test.numeric_jacobian(f, Theta), 'AbsTol', 1e-8);
+    end
+  end
+  methods (Static)
+    function fx = step(f_fname, X, Theta, ut, in)
+      [~, Xt] = pspm_dcm_integrate(f_fname, X, Theta, ut, in);
+      fx = Xt(:, 2);
+    end
+    function J = numeric_jacobian(f, x)
+      % central differences, in the transposed VBA convention
+      h = 1e-6;
+      J = zeros(numel(x), numel(f(x)));
+      for p = 1:numel(x)
+        e = zeros(size(x));
+        e(p) = h;
+        J(p, :) = (f(x + e) - f(x - e))' / (2 * h);
+      end
+    end
+  end
+end
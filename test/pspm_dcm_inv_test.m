@@ -0,0 +1,145 @@
+classdef pspm_dcm_inv_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_dcm_inv function
+  properties (Constant)
+    % fixed response amplitudes (mcS) of the simulated data, and trial
+    % windows (in samples at 10 Hz) for onsets every 12 s and depth 2
+    amplitude = [1; 0.4; 1.6; 0.8];
+    win = {50:290, 170:410, 290:530, 410:530};
+  end
+  properties
+    model;
+    options;
+  end
+  methods (TestClassSetup)
+    function prepare_model(this)
+      % model and options as passed to pspm_dcm_inv by pspm_dcm, for four
+      % trials with a flexible window and a fixed response 3.5 s later;
+      % the data are canonical SCRs with known amplitudes on a constant
+      % level, sampled at 100 Hz for 60 s
+      sr = 100;
+      onsets = (5:12:41)';
+      [bs, ~] = pspm_bf_scrf(1/sr);
+      scr = 2 + 0.01 * sin((1:(60 * sr))' / 70);
+      for k = 1:numel(onsets)
+        idx = round((onsets(k) + 3.5) * sr) + (1:numel(bs));
+        idx = idx(idx <= numel(scr));
+        scr(idx) = scr(idx) + this.amplitude(k) * bs(1:numel(idx));
+      end
+      infos.duration = 60;
+      data{1}.data = scr;
+      data{1}.header = struct('sr', sr, 'chantype', 'scr', 'units', 'uS');
+      datafile = [tempname, '.mat'];
+      save(datafile, 'data', 'infos');
+      timing = {[onsets, onsets + 3.5], onsets + 3.5};
+      model = struct('modelfile', [tempname, '.mat'], 'datafile', datafile, ...
+        'timing', {timing});
+      [sts, dcm] = pspm_dcm(model, struct('dispwin', 0, 'nosave', 1));
+      delete(datafile);
+      this.assertEqual(sts, 1);
+      this.model = dcm.invmodel;
+      this.options = dcm.options;
+    end
+  end
+  methods (Test)
+    function sequential_inversion(this)
+      % trial windows, input data and fitted time course of the sequential
+      % inversion, and the simulated fixed response amplitudes relative to
+      % the largest one
+      [sts, dcm] = pspm_dcm_inv(this.model, this.options);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(numel(dcm.sn), 1);
+      this.verifyEqual(dcm.sn{1}.win, this.win);
+      for trl = 1:numel(this.win)
+        this.verifyEqual(dcm.sn{1}.indata{trl}, ...
+          reshape(dcm.sn{1}.y(this.win{trl}), 1, []));
+      end
+      this.verifyEqual(dcm.sn{1}.yhat, sum(dcm.sn{1}.Xt([1 4 7], :)));
+      this.verifyEqual(numel(dcm.sn{1}.e), numel(this.amplitude));
+      a = [dcm.sn{1}.e.a]';
+      this.verifyTrue(all(a > 0));
+      this.verifyEqual(a / max(a), this.amplitude / max(this.amplitude), ...
+        'AbsTol', 0.15);
+    end
+    function sequential_diagnostics(this)
+      [sts, dcm] = pspm_dcm_inv(this.model, this.options);
+      this.verifyEqual(sts, 1);
+      trlno = numel(dcm.sn{1}.a);
+      d = dcm.sn{1}.diagnostics;
+      this.verifyEqual(d.runs, ones(1, trlno));
+      this.verifyEqual(d.carry_error, zeros(1, trlno));
+      this.verifyTrue(all(ismember(d.converged, [0, 1])));
+      this.verifyTrue(all(d.iterations >= 1));
+      this.verifyTrue(all(isfinite(d.F)));
+      this.verifyEqual(dcm.schedule.workers, 0);
+      this.verifyEqual(dcm.schedule.rounds, trlno);
+      this.verifyEqual(dcm.schedule.inversions, trlno);
+      this.verifyGreaterThan(dcm.schedule.time, 0);
+      this.verifyGreaterThan(dcm.schedule.speedup, 0);
+    end
+    function speculative_inversion(this)
+      % with speculative_tol = 0, every trial window is finally inverted from
+      % its exact start, such that the results equal the sequential
+      % inversion; without a parallel pool, this runs on one worker
+      this.use_one_worker_without_pool();
+      [~, seq] = pspm_dcm_inv(this.model, this.options);
+      options = this.options;
+      options.parallel = 1;
+      options.speculative_tol = 0;
+      [sts, dcm] = pspm_dcm_inv(this.model, options);
+      this.verifyEqual(sts, 1);
+      fields = {'a', 'e', 'sf', 'scl', 'Xt', 'yhat'};
+      for f = 1:numel(fields)
+        this.verifyEqual(dcm.sn{1}.(fields{f}), seq.sn{1}.(fields{f}), ...
+          'AbsTol', 1e-10, fields{f});
+      end
+      trlno = numel(seq.sn{1}.a);
+      d = dcm.sn{1}.diagnostics;
+      this.verifyEqual(d.runs(1), 1);
+      this.verifyTrue(all(d.runs >= 1));
+      this.verifyEqual(d.carry_error, zeros(1, trlno));
+      this.verifyEqual(d.converged, seq.sn{1}.diagnostics.converged);
+      this.verifyEqual(d.F, seq.sn{1}.diagnostics.F, 'AbsTol', 1e-8);
+      this.verifyGreaterThan(dcm.schedule.workers, 0);
+      this.verifyLessThanOrEqual(dcm.schedule.rounds, trlno);
+      this.verifyEqual(dcm.schedule.inversions, sum(d.runs));
+    end
+    function speculative_tolerance(this)
+      % speculative starts are accepted within the tolerance
+      this.use_one_worker_without_pool();
+      options = this.options;
+      options.parallel = 1;
+      options.speculative_tol = 0.1;
+      [sts, dcm] = pspm_dcm_inv(this.model, options);
+      this.verifyEqual(sts, 1);
+      trlno = numel(dcm.sn{1}.a);
+      d = dcm.sn{1}.diagnostics;
+      this.verifyTrue(all(d.carry_error <= options.speculative_tol));
+      this.verifyTrue(all(d.runs >= 1));
+      this.verifyLessThanOrEqual(dcm.schedule.rounds, trlno);
+      this.verifyEqual(dcm.schedule.inversions, sum(d.runs));
+      this.verifyTrue(all(isfinite(dcm.sn{1}.yhat)));
+    end
+    function no_parallel_pool(this)
+      % without a parallel pool, the trials are inverted sequentially
+      this.assumeEmpty(ver('parallel'), 'Parallel Computing Toolbox is installed.');
+      options = this.options;
+      options.parallel = 1;
+      this.verifyWarning(@() pspm_dcm_inv(this.model, options), 'ID:no_parallel_pool');
+    end
+  end
+  methods
+    function use_one_worker_without_pool(this)
+      % without Parallel Computing Toolbox, gcp is replaced by a pool with
+      % one worker, such that the speculative inversion runs on the client
+      if ~isempty(ver('parallel'))
+        return
+      end
+      folder = this.applyFixture(matlab.unittest.fixtures.TemporaryFolderFixture);
+      fid = fopen(fullfile(folder.Folder, 'gcp.m'), 'w');
+      fprintf(fid, 'function pool = gcp\npool = struct(''NumWorkers'', 1);\n');
+      fclose(fid);
+      this.applyFixture(matlab.unittest.fixtures.PathFixture(folder.Folder));
+    end
+  end
+end
@@ -0,0 +1,127 @@
+classdef pspm_dcm_iphi_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_dcm_iphi function
+  properties(Constant)
+    sr = 10;
+    n_t = 300;
+  end
+  methods (Test)
+    function equals_vba_iphi(this)
+      [phi, y, posterior, suffStat, dim, u, options] = this.setup_model();
+      [I1, S1, d1, s1] = VBA_Iphi(phi, y, posterior, suffStat, dim, u, options);
+      [I2, S2, d2, s2] = pspm_dcm_iphi(phi, y, posterior, suffStat, dim, u, options);
+      this.verifyEqual(I2, I1, 'RelTol', 1e-8);
+      this.verifyEqual(S2, S1, 'RelTol', 1e-6, 'AbsTol', 1e-12);
+      this.verifyEqual(d2, d1, 'RelTol', 1e-6, 'AbsTol', 1e-12);
+      this.verifyEqual(s2.gx, s1.gx, 'AbsTol', 1e-10);
+      this.verifyEqual(s2.dy2, s1.dy2, 'RelTol', 1e-8);
+      this.verifyEqual(s2.vy, s1.vy, 'RelTol', 1e-8);
+      this.verifyEqual(s2.muX, s1.muX, 'AbsTol', 1e-10);
+      this.verifyEqual(s2.SigmaX{end}, s1.SigmaX{end}, 'AbsTol', 1e-10);
+      this.verifyEqual(s2.div, s1.div);
+    end
+    function equals_vba_iphi_sf(this)
+      [phi, y, posterior, suffStat, dim, u, options] = this.setup_sf_model();
+      [I1, S1, d1, s1] = VBA_Iphi(phi, y, posterior, suffStat, dim, u, options);
+      [I2, S2, d2, s2] = pspm_dcm_iphi(phi, y, posterior, suffStat, dim, u, options);
+      this.verifyEqual(I2, I1, 'RelTol', 1e-8);
+      this.verifyEqual(S2, S1, 'RelTol', 1e-6, 'AbsTol', 1e-12);
+      this.verifyEqual(d2, d1, 'RelTol', 1e-6, 'AbsTol', 1e-12);
+      this.verifyEqual(s2.gx, s1.gx, 'AbsTol', 1e-10);
+      this.verifyEqual(s2.dy2, s1.dy2, 'RelTol', 1e-8);
+      this.verifyEqual(s2.vy, s1.vy, 'RelTol', 1e-8);
+      this.verifyEqual(s2.muX, s1.muX, 'AbsTol', 1e-10);
+      this.verifyEqual(s2.SigmaX{end}, s1.SigmaX{end}, 'AbsTol', 1e-10);
+    end
+    function sf_dcm_backend(this)
+      % pspm_sf_dcm gives the same estimates with both backends
+      t = (1:this.n_t)' / this.sr;
+      scr = 2 + exp(-(t - 8).^2) + 0.5 * exp(-(t - 20).^2 / 2);
+      model = struct('scr', scr, 'sr', this.sr);
+      options = struct('dispwin', 0, 'dispsmallwin', 0);
+      [sts1, out1] = pspm_sf_dcm(model, options);
+      options.vb_backend = 'pspm';
+      [sts2, out2] = pspm_sf_dcm(model, options);
+      this.verifyEqual(sts1, 1);
+      this.verifyEqual(sts2, 1);
+      this.verifyEqual(out2.t, out1.t, 'AbsTol', 1e-4);
+      this.verifyEqual(out2.a, out1.a, 'RelTol', 1e-4, 'AbsTol', 1e-8);
+    end
+    function unsupported_model(this)
+      % models other than f_SCR are passed on to VBA_Iphi
+      [phi, y, posterior, suffStat, dim, u, options] = this.setup_model();
+      options.inG.old.options.decim = 2;
+      [I1, ~, d1] = VBA_Iphi(phi, y, posterior, suffStat, dim, u, options);
+      [I2, ~, d2] = pspm_dcm_iphi(phi, y, posterior, suffStat, dim, u, options);
+      this.verifyEqual(I2, I1);
+      this.verifyEqual(d2, d1);
+    end
+  end
+  methods
+    function [phi, y, posterior, suffStat, dim, u, options] = setup_model(this)
+      global settings
+      if isempty(settings)
+        pspm_init;
+      end
+      % one eSCR at 5 s
+      u = zeros(6, this.n_t + 1);
+      u(1, :) = (0:this.n_t) / this.sr;
+      u(3, :) = 1;
+      u(6, :) = 5;
+      u(:, 1) = 0;
+      theta = [log([0.122505, 1.411425, 1.342052, 1.533879]), 0.5, 0.6, 0.7, 0.2]';
+      in = struct('dt', 1 / this.sr);
+      [~, Xt] = pspm_dcm_integrate('f_SCR', zeros(7, 1), theta, u(:, 1:this.n_t), in);
+      y = Xt(1, 2:end) + Xt(4, 2:end) + Xt(7, 2:end) + 0.01 * sin((1:this.n_t) / 7);
+      dim = struct('n', 7, 'n_theta', 8, 'n_phi', 0);
+      priors = struct('muPhi', [], 'SigmaPhi', [], 'a_sigma', 1e2, 'b_sigma', 1e-2, ...
+        'a_alpha', Inf, 'b_alpha', 0);
+      priors.muTheta = theta + [zeros(7, 1); 0.3];
+      priors.SigmaTheta = diag([zeros(7, 1); 10]);
+      priors.muX0 = zeros(7, 1);
+      priors.SigmaX0 = diag([1e-2, 1e-2, 1e-2, 0, 0, 0, 1e-2]);
+      options = struct('priors', priors, 'inF', in, 'inG', struct('ind', 1), ...
+        'DisplayWin', 0, 'verbose', 0);
+      options.isYout = zeros(1, this.n_t);
+      options.isYout(100:110) = 1;
+      [options, u, dim] = VBA_check(y, u, 'f_SCR', 'g_SCR', dim, options);
+      posterior = options.priors;
+      posterior.muX = zeros(0, dim.n_t);
+      suffStat = VBA_getSuffStat(options, [], 0);
+      phi = options.priors.muPhi(options.params2update.phi) + 0.05;
+    end
+    function [phi, y, posterior, suffStat, dim, u, options] = setup_sf_model(this)
+      % SF model as set up by pspm_sf_dcm, with three responses
+      global settings
+      if isempty(settings)
+        pspm_init;
+      end
+      nresp = 3;
+      u = zeros(2, this.n_t);
+      u(1, :) = (1:this.n_t) / this.sr;
+      u(2, :) = nresp;
+      % response times and log amplitudes
+      theta = pspm_sf_theta;
+      theta = [theta(1:3), 5, 0.5, 12, 0.2, 20, -0.3]';
+      in = struct('dt', 1 / this.sr);
+      [~, Xt] = pspm_dcm_integrate('f_SF', [0.1; 0; 0], theta, u, in);
+      y = Xt(1, 2:end) + 0.01 * sin((1:this.n_t) / 7);
+      dim = struct('n', 3, 'n_theta', numel(theta), 'n_phi', 2);
+      priors = struct('muPhi', [0; 0], 'SigmaPhi', zeros(2), 'a_sigma', 1e5, ...
+        'b_sigma', 1e1, 'a_alpha', Inf, 'b_alpha', 0);
+      priors.muTheta = theta + [zeros(3, 1); repmat([0.2; 0.5], nresp, 1)];
+      priors.SigmaTheta = diag([zeros(3, 1); repmat([1e-2; 1e2], nresp, 1)]);
+      priors.muX0 = [0.1; 0; 0];
+      priors.SigmaX0 = 1e-8 * eye(3);
+      options = struct('priors', priors, 'inF', in, 'inG', struct('ind', 1), ...
+        'DisplayWin', 0, 'verbose', 0);
+      options.isYout = zeros(1, this.n_t);
+      options.isYout(50:55) = 1;
+      [options, u, dim] = VBA_check(y, u, 'f_SF', 'g_Id', dim, options);
+      posterior = options.priors;
+      posterior.muX = zeros(0, dim.n_t);
+      suffStat = VBA_getSuffStat(options, [], 0);
+      phi = options.priors.muPhi(options.params2update.phi) + 0.05;
+    end
+  end
+end
@@ -75,7 +75,7 @@ classdef pspm_dcm_test < pspm_testcase
       % options
       % numeric fields
       num_fields = {'depth', 'sfpre', 'sfpost', 'sffreq', 'sclpre', ...
-        'sclpost', 'aSCR_sigma_offset'};
+        'sclpost', 'aSCR_sigma_offset', 'speculative_tol'};
       for f = 1:numel(num_fields)
         fl = num_fields{f};
         values = {'a', {}};
@@ -87,7 +87,7 @@ classdef pspm_dcm_test < pspm_testcase
       end
       % boolean fields
       bool_fields = {'crfupdate', 'indrf', 'getrf', 'dispwin', ...
-        'dispsmallwin', 'nosave'};
+        'dispsmallwin', 'nosave', 'parallel'};
       for f = 1:numel(bool_fields)
         fl = bool_fields{f};
         values = {'a', 2};
@@ -68,44 +68,33 @@ methods (Test)
 
     function testNonIntegerFrequencyRatioWithSignalProcessing(testCase)
         % Test case for non-integer frequency ratio downsampling with signal processing available
-
         global settings
-        settings.signal = true;   % Can I do that like this?
-        sr = 1000;                % Original sampling rate
-        sr_down = 333;            % Target sampling rate (non-integer ratio)
-        duration = 1;             %  (in seconds)
-        t = 0:1/sr:duration-1/sr;  % Time vector
-        data = sin(2 * pi * 5 * t); % Sample sine wave signal
-
-        % Expected downsampling result using MATLAB's resample function
-        expectedData = resample(data, sr_down, sr);
-
-        % Perform downsampling
-        [sts, actualData] = pspm_downsample(data, sr, sr_down);
-
-        % Verify output
-        testCase.verifyEqual(sts, 1);
-        testCase.verifyEqual(actualData,expectedData)
-
+        settings.signal = true;
+        testCase.verifyNonIntegerFrequencyRatio();
     end
 
     function testNonIntegerFrequencyRatioWithoutSignalProcessing(testCase)
-        % Test case for non-integer frequency ratio downsampling without signal processing
+        % Test case for non-integer frequency ratio downsampling without
+        % signal processing, which gives the same result
         global settings;
         settings.signal = false; % Signal processing not available
-        sr = 1000;               % Original sampling rate
-        sr_down = 333;           % Target sampling rate (non-integer ratio)
-        duration = 1;            % Signal duration (in seconds)
-        t = 0:1/sr:duration-1/sr; % Time vector
-        data = sin(2 * pi * 5 * t); % Sample sine wave signal
-
-        % Perform downsampling
-        [sts, actualData] = pspm_downsample(data, sr, sr_down);
+        testCase.verifyNonIntegerFrequencyRatio();
+    end
 
-        % Verify output
-        testCase.verifyEqual(sts, -1);
-        testCase.verifyEqual(actualData,data)
+    function testMultiChannel(testCase)
+        % Test case for resampling several channels at once
+        sr = 100;
+        sr_down = 30;
+        t = (0:999)' / sr;
+        data = [sin(2 * pi * t), cos(2 * pi * 3 * t)];
+        [sts, actualData, newsr] = pspm_downsample(data, sr, sr_down);
+        testCase.verifyEqual(sts, 1);
+        testCase.verifyEqual(newsr, sr_down);
+        testCase.verifySize(actualData, [300, 2]);
+        [~, firstChannel] = pspm_downsample(data(:, 1), sr, sr_down);
+        testCase.verifyEqual(actualData(:, 1), firstChannel, 'AbsTol', 1e-12);
     end
+
     function testIntegerFrequencyRatioWithoutSignalProcessing(testCase)
         % Test case for non-integer frequency ratio downsampling without signal processing
         global settings;
@@ -129,5 +118,26 @@ methods (Test)
     end
 
 
+end
+methods
+    function verifyNonIntegerFrequencyRatio(testCase)
+        sr = 1000;                % Original sampling rate
+        sr_down = 333;            % Target sampling rate (non-integer ratio)
+        duration = 1;             %  (in seconds)
+        t = 0:1/sr:duration-1/sr;  % Time vector
+        data = sin(2 * pi * 5 * t) + 1; % Sample sine wave signal
+
+        % Perform downsampling
+        [sts, actualData, newsr] = pspm_downsample(data, sr, sr_down);
+
+        % Verify output: the requested rate is kept exactly, and the
+        % resampled signal follows the sine wave away from the edges
+        testCase.verifyEqual(sts, 1);
+        testCase.verifyEqual(newsr, sr_down);
+        testCase.verifySize(actualData, [1, 333]);
+        t_down = (0:332) / sr_down;
+        expectedData = sin(2 * pi * 5 * t_down) + 1;
+        testCase.verifyEqual(actualData(20:end-20), expectedData(20:end-20), 'AbsTol', 1e-3);
+    end
 end
 end
@@ -217,6 +217,13 @@ classdef pspm_expand_epochs_test < pspm_testcase
             this.verifyThat(expanded_epochs, IsEqualTo(expected_epochs));
         end
 
+        function ExpandEpochsAtZeroTest(this)
+            % Epochs expanded to before 0 are clipped, not removed
+            [sts, expanded_epochs] = pspm_expand_epochs([0, 0; 5, 10], [1, 0]);
+            this.verifyEqual(sts, 1);
+            this.verifyEqual(expanded_epochs, [0, 0; 4, 10]);
+        end
+
         function ExpandEpochsWithEpochsFileTest(this)
 
 
@@ -122,5 +122,17 @@ classdef pspm_extract_segments_core_test < matlab.unittest.TestCase
           this.verifyEqual(segments, expected_segments);
           this.verifyEqual(sessions, expected_sessions);
       end
+
+      function test_statistics(this)
+          data = {1:10, 11:20};
+          onsets = {[3, 9], 4};
+          missing = {false(1, 10), [false(1, 4), true, false(1, 5)]};
+          segment_length = 3;
+          [~, segments, ~, stats] = pspm_extract_segments_core(data, onsets, segment_length, missing);
+          this.verifyEqual(segments, [3,4,5; 9,10,NaN; 14,NaN,16]);
+          this.verifyEqual(stats.mean, [26/3, 7, 21/2], 'AbsTol', 1e-12);
+          this.verifyEqual(stats.std, [std([3,9,14]), std([4,10]), std([5,16])], 'AbsTol', 1e-12);
+          this.verifyEqual(stats.sem, stats.std / sqrt(3), 'AbsTol', 1e-12);
+      end
   end
 end
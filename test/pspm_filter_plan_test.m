@@ -0,0 +1,35 @@
+classdef pspm_filter_plan_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_filter_plan function
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_filter_plan(), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_filter_plan(struct('sr', 100)), 'ID:invalid_input');
+    end
+    function plan(this)
+      pspm_filter_plan('clear');
+      filt = struct('sr', 100, 'lpfreq', 5, 'lporder', 4, 'hpfreq', 0.05, ...
+        'hporder', 1, 'direction', 'bi');
+      [sts, plan] = pspm_filter_plan(filt);
+      this.verifyEqual(sts, 1);
+      this.verifySize(plan.lp.b, [2, 6]);
+      this.verifySize(plan.lp.zi, [2, 2]);
+      this.verifyEqual(numel(plan.hp.b), 2);
+      % Verify that the same specification returns the cached plan
+      [~, plan2] = pspm_filter_plan(filt);
+      this.verifyEqual(plan2, plan);
+      % Verify that no initial conditions are computed for uni direction,
+      % and that low pass filters above the Nyquist frequency are skipped
+      filt.direction = 'uni';
+      filt.lpfreq = 60;
+      [~, plan3] = pspm_filter_plan(filt);
+      this.verifyEmpty(plan3.lp);
+      this.verifyEmpty(plan3.hp.zi);
+      this.verifyNotEqual(plan3.key, plan.key);
+      % Verify that 'none' disables filters
+      filt.hpfreq = 'none';
+      [~, plan4] = pspm_filter_plan(filt);
+      this.verifyEmpty(plan4.hp);
+    end
+  end
+end
@@ -9,6 +9,43 @@ classdef pspm_filtfilt_test < matlab.unittest.TestCase
       this.verifyWarning(@() pspm_filtfilt(), 'ID:invalid_input');
       % Verify that data must have length more than 3 times filter order.
       this.verifyWarning(@() pspm_filtfilt([1:10],[1:20],[1:10]), 'ID:invalid_input');
+      % Verify the same for second-order sections
+      sos = repmat([1 0 0 1 0 0], 4, 1);
+      this.verifyWarning(@() pspm_filtfilt(sos,1,1:20), 'ID:invalid_input');
+    end
+    function multi_column(this)
+      % Verify that columns are filtered independently
+      b = [0.2 0.2];
+      a = [1 -0.6];
+      x = [sin((1:500)'/20), cos((1:500)'/7), (1:500)'];
+      [sts, y] = pspm_filtfilt(b,a,x);
+      this.verifyEqual(sts, 1);
+      this.verifySize(y, size(x));
+      for i = 1:size(x,2)
+        [~, yi] = pspm_filtfilt(b,a,x(:,i));
+        this.verifyEqual(y(:,i), yi, 'AbsTol', 1e-10);
+      end
+      % Verify that row vectors are returned as row vectors
+      [~, yr] = pspm_filtfilt(b,a,x(:,1)');
+      this.verifyEqual(yr, y(:,1)', 'AbsTol', 1e-10);
+    end
+    function second_order_sections(this)
+      % Verify that a cascade of two first-order sections filters a
+      % constant signal without transients and agrees with the equivalent
+      % transfer function away from the edges
+      b = [0.2 0.2];
+      a = [1 -0.6];
+      sos = [b 0 a 0; b 0 a 0];
+      [sts, y] = pspm_filtfilt(sos,1,ones(200,2));
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(y, ones(200,2), 'AbsTol', 1e-10);
+      x = sin((1:1000)'/50);
+      [~, y_sos] = pspm_filtfilt(sos,1,x);
+      [~, y_tf] = pspm_filtfilt(conv(b,b),conv(a,a),x);
+      this.verifyEqual(y_sos(100:900), y_tf(100:900), 'AbsTol', 1e-6);
+      % Verify that the gain is applied
+      [~, y_g] = pspm_filtfilt(sos,[2 0.5],x);
+      this.verifyEqual(y_g, y_sos, 'AbsTol', 1e-10);
     end
   end
 end
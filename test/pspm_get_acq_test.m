@@ -77,6 +77,146 @@ classdef pspm_get_acq_test < pspm_get_superclass
       import matlab.unittest.constraints.RelativeTolerance
       this.verifyThat(orig_data, IsEqualTo(acq_data, 'Within', RelativeTolerance(1e-10)));
     end
+    function synthetic_file(this)
+      % three channels at 100, 50 and 25 Hz, of types int16 and double,
+      % and two markers
+      fn = [tempname, '.acq'];
+      [chan, markers] = this.synthetic_channels();
+      this.write_acq(fn, 10, chan, markers);
+      this.applyFixture(matlab.unittest.fixtures.PathFixture(pspm_path('Import', 'acq')));
+      [sts, info, data] = import_acq(fn);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(info.lVersion, 43);
+      this.verifyEqual(info.nChannels, 3);
+      this.verifyEqual(info.dSampleTime, 10);
+      this.verifyEqual(info.szCommentText, {chan.label});
+      this.verifyEqual(info.szUnitsText, {chan.units});
+      this.verifyEqual(info.lBufLength, [12, 6, 3]);
+      this.verifyEqual(info.dAmplScale, [chan.scale]);
+      this.verifyEqual(info.dAmplOffset, [chan.offset]);
+      this.verifyEqual(info.nVarSampleDivider, [1, 2, 4]);
+      this.verifyEqual(info.nSize, [2, 8, 2]);
+      this.verifyEqual(info.nType, [2, 1, 2]);
+      for n = 1:numel(chan)
+        this.verifyEqual(data{n}, chan(n).data);
+      end
+      this.verifyEqual(info.lSample, [markers.sample]);
+      this.verifyEqual(info.szText, {markers.text});
+      % scaled data and channel-specific sample rates
+      import{1} = struct('type', 'scr', 'channel', 1);
+      import{2} = struct('type', 'resp', 'channel', 2);
+      import{3} = struct('type', 'marker', 'channel', 3);
+      import = this.assign_chantype_number(import);
+      [sts, import] = pspm_get_acq(fn, import);
+      delete(fn);
+      this.verifyEqual(sts, 1);
+      sr = [100, 50, 25];
+      for n = 1:numel(chan)
+        this.verifyEqual(import{n}.sr, sr(n), 'AbsTol', 1e-10);
+        this.verifyEqual(import{n}.data, ...
+          chan(n).scale * double(chan(n).data) + chan(n).offset, 'AbsTol', 1e-12);
+      end
+      this.verifyEqual(import{3}.marker, 'continuous');
+    end
+    function invalid_file(this)
+      this.applyFixture(matlab.unittest.fixtures.PathFixture(pspm_path('Import', 'acq')));
+      % unsupported version
+      fn = [tempname, '.acq'];
+      fid = fopen(fn, 'w');
+      fwrite(fid, zeros(1, 24), 'uint8');
+      fclose(fid);
+      this.verifyWarning(@() import_acq(fn), 'ID:invalid_data_structure');
+      % truncated data section
+      chan = this.synthetic_channels();
+      this.write_acq(fn, 10, chan, []);
+      fid = fopen(fn, 'r');
+      bytes = fread(fid, Inf, '*uint8');
+      fclose(fid);
+      fid = fopen(fn, 'w');
+      fwrite(fid, bytes(1:end - 2), 'uint8');
+      fclose(fid);
+      this.verifyWarning(@() import_acq(fn), 'ID:invalid_data_structure');
+      delete(fn);
+    end
+  end
+  methods (Static)
+    function [chan, markers] = synthetic_channels()
+      chan = struct( ...
+        'label', {'SCR', 'Respiration', 'Digital input'}, ...
+        'units', {'microsiemens', 'Volts', 'Volts'}, ...
+        'scale', {0.01, 1, 0.5}, ...
+        'offset', {2, 0, -1}, ...
+        'divider', {1, 2, 4}, ...
+        'data', {int16(100 * (1:12)' - 600), [0.5; -1.25; 2; 0; 3.75; -0.5], int16([0; 5; 0])});
+      markers = struct('sample', {3, 10}, 'text', {'start', 'probe 2'});
+    end
+    function write_acq(fn, dt, chan, markers)
+      % write an AcqKnowledge file (version 43) with sample time dt (ms),
+      % the channels in the struct array chan (label, units, scale, offset,
+      % divider, and int16 or double data) and the markers in the struct
+      % array markers (sample, text); graph and channel headers are 256
+      % bytes long, and only the fields read by import_acq are set
+      nch = numel(chan);
+      pad = @(str, n) [double(str), zeros(1, n - numel(str))];
+      fid = fopen(fn, 'w', 'ieee-le');
+      % graph header
+      fwrite(fid, zeros(1, 256), 'uint8');
+      fseek(fid, 2, 'bof');
+      fwrite(fid, [43, 256], 'int32');
+      fwrite(fid, nch, 'int16');
+      fseek(fid, 16, 'bof');
+      fwrite(fid, dt, 'double');
+      % per channel data section
+      for n = 1:nch
+        pos = 256 * n;
+        fseek(fid, 0, 'eof');
+        fwrite(fid, zeros(1, 256), 'uint8');
+        fseek(fid, pos, 'bof');
+        fwrite(fid, 256, 'int32');
+        fseek(fid, pos + 6, 'bof');
+        fwrite(fid, pad(chan(n).label, 40), 'uint8');
+        fseek(fid, pos + 68, 'bof');
+        fwrite(fid, pad(chan(n).units, 20), 'uint8');
+        fwrite(fid, numel(chan(n).data), 'int32');
+        fwrite(fid, [chan(n).scale, chan(n).offset], 'double');
+        fseek(fid, pos + 250, 'bof');
+        fwrite(fid, chan(n).divider, 'int16');
+      end
+      fseek(fid, 0, 'eof');
+      % foreign data section without content, and data types
+      fwrite(fid, [4, 0], 'int16');
+      for n = 1:nch
+        if isa(chan(n).data, 'double')
+          fwrite(fid, [8, 1], 'int16');
+        else
+          fwrite(fid, [2, 2], 'int16');
+        end
+      end
+      % interleaved samples: at base sample k, every channel whose divider
+      % divides k, in channel order
+      len = arrayfun(@(c) numel(c.data), chan);
+      count = zeros(1, nch);
+      k = 0;
+      while any(count < len)
+        for n = 1:nch
+          if mod(k, chan(n).divider) == 0 && count(n) < len(n)
+            count(n) = count(n) + 1;
+            fwrite(fid, chan(n).data(count(n)), class(chan(n).data));
+          end
+        end
+        k = k + 1;
+      end
+      % markers
+      if ~isempty(markers)
+        fwrite(fid, [8 + sum(arrayfun(@(m) 13 + numel(m.text), markers)), numel(markers)], 'int32');
+        for m = 1:numel(markers)
+          fwrite(fid, markers(m).sample, 'int32');
+          fwrite(fid, [0, 0, 0, numel(markers(m).text)], 'int16');
+          fwrite(fid, [double(markers(m).text), 0], 'uint8');
+        end
+      end
+      fclose(fid);
+    end
   end
 end
 
@@ -36,5 +36,61 @@ classdef pspm_get_edf_test < pspm_get_superclass
       import = this.assign_chantype_number(import);
       this.verifyWarning(@()pspm_get_edf(fn, import), 'ID:channel_not_contained_in_file');
     end
+    function annotations_and_triggers(this)
+      % write a minimal EDF+ file with one trigger channel (10 Hz) and one
+      % annotation channel, 3 records of 1 s each
+      fn = [tempname, '.edf'];
+      trig = zeros(30, 1);
+      trig(6:10) = 2;
+      trig(21:23) = 5;
+      tal = {['+0', char([20 20 0]), '+0', char(20), 'rec', char([20 0])], ...
+        ['+1', char([20 20 0]), '+1.5', char(21), '0.25', char(20), 'cue', char([20 0])], ...
+        ['+2', char([20 20 0]), '+2.2', char(20), '7', char(20), 'probe', char([20 0])]};
+      this.write_edf(fn, {'Trigger', 'EDF Annotations'}, [10, 30], trig, tal);
+      import{1} = struct('type', 'marker', 'channel', 0);
+      import{2} = struct('type', 'marker', 'channel', 1);
+      import = this.assign_chantype_number(import);
+      [sts, import] = pspm_get_edf(fn, import);
+      delete(fn);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(import{1}.data, [0; 1.5; 2.2; 2.2]);
+      this.verifyEqual(import{1}.markerinfo.name, {'rec'; 'cue'; '7'; 'probe'});
+      this.verifyEqual(import{1}.markerinfo.duration, [NaN; 0.25; NaN; NaN]);
+      this.verifyEqual(import{1}.markerinfo.value(3), 7);
+      this.verifyEqual(import{2}.data, [0.5; 2], 'AbsTol', 1e-12);
+      this.verifyEqual(import{2}.markerinfo.duration, [0.5; 0.3], 'AbsTol', 1e-12);
+      this.verifyEqual(import{2}.markerinfo.value, [2; 5], 'AbsTol', 1e-3);
+    end
+  end
+  methods (Static)
+    function write_edf(fn, label, nsamples, sig, tal)
+      % write an EDF+ file with one signal channel sig and one annotation
+      % channel with one TAL string per record
+      ns = numel(label);
+      nrec = numel(tal);
+      pad = @(str, n) [str, repmat(' ', 1, n - numel(str))];
+      fid = fopen(fn, 'w', 'ieee-le');
+      fwrite(fid, [pad('0', 8), pad('X X X X', 80), pad('Startdate X X X X', 80), ...
+        '01.01.26', '00.00.00', pad(num2str(256 * (ns + 1)), 8), pad('EDF+C', 44), ...
+        pad(num2str(nrec), 8), pad('1', 8), pad(num2str(ns), 4)], 'char');
+      fields = {label, {'', ''}, {'V', ''}, {'-32768', '-1'}, {'32767', '1'}, ...
+        {'-32768', '-32768'}, {'32767', '32767'}, {'', ''}, ...
+        cellfun(@num2str, num2cell(nsamples / nrec), 'UniformOutput', false), {'', ''}};
+      len = [16 80 8 8 8 8 8 80 8 32];
+      for f = 1:numel(fields)
+        for c = 1:ns
+          fwrite(fid, pad(fields{f}{c}, len(f)), 'char');
+        end
+      end
+      n1 = nsamples(1) / nrec;
+      n2 = nsamples(2) / nrec;
+      for r = 1:nrec
+        fwrite(fid, sig((r - 1) * n1 + (1:n1)), 'int16');
+        bytes = zeros(1, 2 * n2);
+        bytes(1:numel(tal{r})) = double(tal{r});
+        fwrite(fid, bytes, 'uint8');
+      end
+      fclose(fid);
+    end
   end
-end
\ No newline at end of file
+end
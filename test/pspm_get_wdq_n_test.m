@@ -29,5 +29,84 @@ classdef pspm_get_wdq_n_test < pspm_get_superclass
       import = this.assign_chantype_number(import);
       this.verifyWarning(@()pspm_get_wdq_n(fn, import), 'ID:channel_not_contained_in_file');
     end
+    function synthetic_file(this)
+      % two channels at 50 Hz with status bits set, and event markers in
+      % the least significant bit of the first channel
+      fn = [tempname, '.wdq'];
+      n = 100;
+      counts = [1:n; n:-1:1];
+      raw = 4 * counts;
+      raw(1, [10, 40]) = raw(1, [10, 40]) + 1;
+      raw(2, 2:2:end) = raw(2, 2:2:end) + 2;
+      m = [0.5, 2];
+      b = [1, -3];
+      this.write_wdq(fn, 0.02, raw, m, b, {'mcS', 'V'});
+      import{1} = struct('type', 'scr', 'channel', 1);
+      import{2} = struct('type', 'marker', 'channel', 0);
+      import{3} = struct('type', 'resp', 'channel', 2);
+      import = this.assign_chantype_number(import);
+      [sts, import] = pspm_get_wdq_n(fn, import);
+      delete(fn);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(import{1}.sr, 50, 'RelTol', 1e-12);
+      this.verifyEqual(import{1}.data, counts(1, :)' * m(1) + b(1));
+      this.verifyEqual(strtrim(import{1}.units), 'mcS');
+      this.verifyEqual(import{3}.data, counts(2, :)' * m(2) + b(2));
+      this.verifyEqual(strtrim(import{3}.units), 'V');
+      % marker timestamps in sample intervals from the start of the file
+      this.verifyEqual(import{2}.marker, 'timestamps');
+      this.verifyEqual(import{2}.data, [9; 39]);
+      this.verifyEqual(import{2}.sr, 0.02, 'RelTol', 1e-12);
+    end
+    function synthetic_hires_file(this)
+      % in HiRes files, all 16 bits are data: samples are divided by 4
+      % without rounding, and there are no event markers
+      fn = [tempname, '.wdq'];
+      raw = [1:2:99; -(1:50)];
+      m = [0.5, 2];
+      b = [1, -3];
+      this.write_wdq(fn, 0.02, raw, m, b, {'mcS', 'V'}, 1);
+      import{1} = struct('type', 'scr', 'channel', 1);
+      import{2} = struct('type', 'marker', 'channel', 0);
+      import{3} = struct('type', 'resp', 'channel', 2);
+      import = this.assign_chantype_number(import);
+      [sts, import] = this.verifyWarning(@() pspm_get_wdq_n(fn, import), 'ID:no_event_markers');
+      delete(fn);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(import{1}.data, raw(1, :)' * 0.25 * m(1) + b(1), 'AbsTol', 1e-12);
+      this.verifyEqual(import{3}.data, raw(2, :)' * 0.25 * m(2) + b(2), 'AbsTol', 1e-12);
+      this.verifyEmpty(import{2}.data);
+    end
+  end
+  methods (Static)
+    function write_wdq(fn, dt, raw, m, b, units, hires)
+      % write an unpacked WinDaq file with a 1156 byte header, one
+      % channel per row of raw, and calibration m * x + b per channel;
+      % with hires, the HiRes bit of header element 27 is set
+      nch = size(raw, 1);
+      fid = fopen(fn, 'w', 'ieee-le');
+      fwrite(fid, zeros(1, 1156), 'uint8');
+      fseek(fid, 0, -1);
+      fwrite(fid, nch, 'uint16');
+      fwrite(fid, 1, 'uint16');
+      fwrite(fid, [110, 36], 'uint8');
+      fwrite(fid, 1156, 'int16');
+      fwrite(fid, 2 * numel(raw), 'uint32');
+      fseek(fid, 28, -1);
+      fwrite(fid, dt, 'double');
+      for i = 1:nch
+        fseek(fid, 110 + 36 * (i - 1), -1);
+        fwrite(fid, [1, 0], 'single');
+        fwrite(fid, [m(i), b(i)], 'double');
+        fwrite(fid, [units{i}, repmat(' ', 1, 6 - numel(units{i}))], 'char');
+      end
+      if nargin > 6 && hires
+        fseek(fid, 100, -1);
+        fwrite(fid, 1, 'uint8');
+      end
+      fseek(fid, 1156, -1);
+      fwrite(fid, raw, 'int16');
+      fclose(fid);
+    end
   end
-end
\ No newline at end of file
+end
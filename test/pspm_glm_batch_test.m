@@ -0,0 +1,52 @@
+classdef pspm_glm_batch_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_glm_batch function
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_glm_batch(), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_glm_batch({}), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_glm_batch({'foo'}), 'ID:invalid_input');
+    end
+    function failed_models(this)
+      % models that cannot be estimated are skipped and reported
+      model = struct('datafile', 'nonexistent_file.mat', ...
+        'modelfile', 'nonexistent_model.mat', 'timeunits', 'seconds', ...
+        'timing', struct('names', {{'a'}}, 'onsets', {{1}}));
+      [sts, modelfiles, stats] = pspm_glm_batch({model, model});
+      this.verifyEqual(sts, -1);
+      this.verifyEmpty(modelfiles);
+      this.verifySize(stats, [2, 0]);
+      % also when estimated in parallel
+      [sts, modelfiles, stats] = pspm_glm_batch({model, model}, struct('parallel', 1));
+      this.verifyEqual(sts, -1);
+      this.verifyEmpty(modelfiles);
+      this.verifySize(stats, [2, 0]);
+    end
+    function parallel_estimation(this)
+      % parallel estimation gives the same estimates as sequential
+      % estimation, and overwrites model files without asking
+      nSubject = 3;
+      models = cell(1, nSubject);
+      for iSubject = 1:nSubject
+        channels{1} = struct('chantype', 'scr', 'sr', 10, 'freq', 0.1 * iSubject, 'noise', 1);
+        channels{2}.chantype = 'marker';
+        models{iSubject} = struct('datafile', [tempname, '.mat'], ...
+          'modelfile', [tempname, '.mat'], 'timeunits', 'seconds', ...
+          'timing', struct('names', {{'a', 'b'}}, 'onsets', {{[5; 25; 45], [15; 35]}}));
+        pspm_testdata_gen(channels, 60, models{iSubject}.datafile);
+      end
+      [sts, modelfiles, stats] = pspm_glm_batch(models, struct('overwrite', 1));
+      this.verifyEqual(sts, 1);
+      [psts, pmodelfiles, pstats] = pspm_glm_batch(models, struct('parallel', 1));
+      this.verifyEqual(psts, 1);
+      this.verifyEqual(pmodelfiles, modelfiles);
+      this.verifyEqual(pstats, stats, 'AbsTol', 1e-10);
+      this.verifyEqual(size(stats, 1), nSubject);
+      this.verifyTrue(all(isfinite(stats(:))));
+      for iSubject = 1:nSubject
+        delete(models{iSubject}.datafile);
+        delete(models{iSubject}.modelfile);
+      end
+    end
+  end
+end
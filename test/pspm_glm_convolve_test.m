@@ -0,0 +1,39 @@
+classdef pspm_glm_convolve_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_glm_convolve function
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_glm_convolve(zeros(10, 1), 10, ones(3, 1)), 'ID:invalid_input');
+      filt = struct('sr', 10, 'lpfreq', NaN, 'lporder', 1, 'hpfreq', 0.05, ...
+        'hporder', 1, 'direction', 'uni', 'down', 'none');
+      this.verifyWarning(@() pspm_glm_convolve(zeros(10, 1), 20, ones(3, 1), filt), 'ID:invalid_input');
+    end
+    function compare_conv(this)
+      % same result as convolving and filtering each column and session
+      sr = 10;
+      snduration = [300, 200];
+      X = zeros(sum(snduration), 2);
+      X([20, 110, 250, 330, 480], 1) = 1;
+      X([20, 110, 250, 330, 480], 2) = [-1, 0.5, 1, -0.2, 0.7];
+      bf = [exp(-(0:99)' / 20), (0:99)' .* exp(-(0:99)' / 10) / 10];
+      for direction = {'uni', 'bi'}
+        filt = struct('sr', sr, 'lpfreq', NaN, 'lporder', 1, 'hpfreq', 0.05, ...
+          'hporder', 1, 'direction', direction{1}, 'down', 'none');
+        [sts, XC] = pspm_glm_convolve(X, snduration, bf, filt);
+        this.verifyEqual(sts, 1);
+        this.verifySize(XC, [sum(snduration), 4]);
+        snonsets = [1, snduration(1) + 1];
+        for k = 1:2
+          for j = 1:2
+            for iSn = 1:2
+              rows = snonsets(iSn) + (0:snduration(iSn) - 1);
+              c = conv(X(rows, k), bf(:, j));
+              [~, c] = pspm_prepdata(c, filt);
+              this.verifyEqual(XC(rows, (k - 1) * 2 + j), c(1:snduration(iSn)), 'AbsTol', 1e-10);
+            end
+          end
+        end
+      end
+    end
+  end
+end
@@ -0,0 +1,39 @@
+classdef pspm_glm_solve_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_glm_solve function
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_glm_solve(ones(3, 2)), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_glm_solve(ones(3, 2), ones(4, 1)), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_glm_solve([1, NaN; 1, 2], ones(2, 1)), 'ID:invalid_input');
+      [~, ~, ~, ~, ~, f] = pspm_glm_solve(ones(3, 2), ones(3, 1));
+      this.verifyWarning(@() pspm_glm_solve(ones(4, 2), ones(4, 1), f), 'ID:invalid_input');
+    end
+    function full_rank(this)
+      X = [randn(200, 3), ones(200, 1)];
+      Y = X * [1; -2; 0.5; 3] + 0.1 * randn(200, 2);
+      [sts, b, Yhat, e, s2, f] = pspm_glm_solve(X, Y);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(b, pinv(X) * Y, 'AbsTol', 1e-10);
+      this.verifyEqual(Yhat, X * b, 'AbsTol', 1e-10);
+      this.verifyEqual(e, Y - Yhat, 'AbsTol', 1e-12);
+      this.verifyEqual(s2, sum(e.^2, 1) / (200 - 4), 'AbsTol', 1e-12);
+      % the returned factorisation gives the same result
+      [~, b2, Yhat2] = pspm_glm_solve(X, Y, f);
+      this.verifyEqual(b2, b);
+      this.verifyEqual(Yhat2, Yhat);
+    end
+    function rank_deficient(this)
+      X = randn(100, 2);
+      X = [X, X(:, 1) + X(:, 2), ones(100, 1)];
+      Y = randn(100, 1);
+      [sts, b, Yhat, ~, ~, f] = pspm_glm_solve(X, Y);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(b, pinv(X) * Y, 'AbsTol', 1e-10);
+      this.verifyEqual(Yhat, X * pinv(X) * Y, 'AbsTol', 1e-10);
+      this.verifyEqual(f.rank, 3);
+      [~, b2] = pspm_glm_solve(X, Y, f);
+      this.verifyEqual(b2, b);
+    end
+  end
+end
@@ -0,0 +1,40 @@
+classdef pspm_interp1_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_interp1 function
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_interp1(), 'ID:invalid_input');
+      x = [NaN; 1; NaN];
+      y = this.verifyWarning(@() pspm_interp1(x), 'ID:invalid_input');
+      this.verifyEqual(y, x);
+    end
+    function linear(this)
+      % interpolation inside the data, extrapolation through the first or
+      % last two valid samples
+      x = [NaN; NaN; 3; 4; NaN; NaN; 10; 11; NaN];
+      y = pspm_interp1(x);
+      this.verifyEqual(y, [1; 2; 3; 4; 6; 8; 10; 11; 12], 'AbsTol', 1e-12);
+      % row vectors stay row vectors
+      this.verifyEqual(pspm_interp1(x'), y', 'AbsTol', 1e-12);
+      % samples marked as missing are interpolated as well
+      y = pspm_interp1([1; 2; 100; 4; 5], [0; 0; 1; 0; 0]);
+      this.verifyEqual(y, (1:5)', 'AbsTol', 1e-12);
+      % no extrapolation
+      y = pspm_interp1(x, [], 'linear', 0);
+      this.verifyEqual(y(3:8), [3; 4; 6; 8; 10; 11], 'AbsTol', 1e-12);
+      this.verifyTrue(all(isnan(y([1, 2, 9]))));
+    end
+    function multi_channel(this)
+      x = [NaN, 1; 2, NaN; 3, 3; NaN, 4; 5, NaN];
+      y = pspm_interp1(x);
+      this.verifyEqual(y, [1, 1; 2, 2; 3, 3; 4, 4; 5, 5], 'AbsTol', 1e-12);
+    end
+    function other_methods(this)
+      x = (1:20)'.^2;
+      x([5, 6, 12]) = NaN;
+      y = pspm_interp1(x, [], 'pchip');
+      this.verifyFalse(any(isnan(y)));
+      this.verifyEqual(y([1:4, 7:11, 13:20]), x([1:4, 7:11, 13:20]));
+    end
+  end
+end
@@ -0,0 +1,43 @@
+classdef pspm_intervals_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_intervals function
+  methods (Test)
+    function merge(this)
+      epochs = [5, 7; 0, 10; 12, 13; 13, 14; 2, 3];
+      this.verifyEqual(pspm_intervals('merge', epochs), [0, 10; 12, 14]);
+      this.verifySize(pspm_intervals('merge', []), [0, 2]);
+    end
+    function expand(this)
+      epochs = [2, 3; 6, 7; 20, 21];
+      this.verifyEqual(pspm_intervals('expand', epochs, [1, 2]), [1, 9; 19, 23]);
+    end
+    function complement(this)
+      epochs = [2, 3; 6, 7];
+      this.verifyEqual(pspm_intervals('complement', epochs, [0, 10]), [0, 2; 3, 6; 7, 10]);
+      this.verifyEqual(pspm_intervals('complement', epochs, [2, 7]), [3, 6]);
+      this.verifyEqual(pspm_intervals('complement', [], [0, 10]), [0, 10]);
+    end
+    function intersect(this)
+      a = [8, 12; 0, 5];
+      b = [3, 9; 11, 20];
+      this.verifyEqual(pspm_intervals('intersect', a, b), [3, 5; 8, 9; 11, 12]);
+      % adjacent epochs do not intersect
+      this.verifyEmpty(pspm_intervals('intersect', [0, 3], [3, 5]));
+      this.verifyEmpty(pspm_intervals('intersect', a, []));
+    end
+    function clip(this)
+      epochs = [-3, -1; -2, 4; 6, 7; 9, 15];
+      this.verifyEqual(pspm_intervals('clip', epochs, [0, 10]), [0, 4; 6, 7; 9, 10]);
+    end
+    function logical_conversion(this)
+      index = logical([0; 1; 1; 0; 0; 1; 0; 0; 1; 1]);
+      epochs = pspm_intervals('from_logical', index);
+      this.verifyEqual(epochs, [2, 4; 6, 7; 9, 11]);
+      this.verifyEqual(pspm_intervals('to_logical', epochs, 10), index);
+      % epochs are clipped to the data
+      this.verifyEqual(pspm_intervals('to_logical', [0, 3; 9, 20], 10), ...
+        logical([1; 1; 0; 0; 0; 0; 0; 0; 1; 1]));
+      this.verifyEqual(pspm_intervals('to_logical', [], 3), false(3, 1));
+    end
+  end
+end
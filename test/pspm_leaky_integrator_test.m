@@ -0,0 +1,50 @@
+classdef pspm_leaky_integrator_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_leaky_integrator function
+  methods
+    function y = reference(~, x, tau)
+      % sample by sample definition of the leaky integrator
+      y = x;
+      for i = 2:numel(x)
+        y(i) = y(i - 1) + (x(i) - y(i - 1)) / tau(min(i, numel(tau)));
+      end
+    end
+  end
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_leaky_integrator(1:10, 0), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_leaky_integrator(1:10, [1 2 3]), 'ID:invalid_input');
+    end
+    function constant_tau(this)
+      x = randn(200, 1);
+      y = pspm_leaky_integrator(x, 7);
+      this.verifyEqual(y, this.reference(x, 7), 'AbsTol', 1e-10);
+      % row vectors stay row vectors
+      this.verifyEqual(pspm_leaky_integrator(x', 7), y', 'AbsTol', 1e-12);
+    end
+    function multi_channel(this)
+      x = randn(200, 3);
+      y = pspm_leaky_integrator(x, [2 5 5]);
+      for i = 1:3
+        tau = [2 5 5];
+        this.verifyEqual(y(:, i), this.reference(x(:, i), tau(i)), 'AbsTol', 1e-10);
+      end
+    end
+    function time_varying_tau(this)
+      x = randn(200, 2);
+      tau = linspace(1, 20, 200)';
+      y = pspm_leaky_integrator(x, tau);
+      for i = 1:2
+        this.verifyEqual(y(:, i), this.reference(x(:, i), tau), 'AbsTol', 1e-10);
+      end
+    end
+    function time_varying_tau_row(this)
+      % row vector data with a row vector of per-sample time constants
+      x = randn(1, 200);
+      tau = linspace(1, 20, 200);
+      y = pspm_leaky_integrator(x, tau);
+      this.verifySize(y, [1, 200]);
+      this.verifyEqual(y, this.reference(x, tau), 'AbsTol', 1e-10);
+    end
+  end
+end
@@ -116,9 +116,10 @@ classdef pspm_prepdata_test < matlab.unittest.TestCase
       filt.hporder = 1;
       filt.direction = 'uni';
       data = rand(filt.sr * 10,1);
-      [sts, outdata, newsr] = this.verifyWarning(@()pspm_prepdata(data, filt), 'ID:freq_change');
+      [sts, outdata, newsr] = pspm_prepdata(data, filt);
       this.verifyTrue(sts == 1, 'sts is negative');
-      this.verifyTrue(newsr == round(filt.down), 'newsr != filt.sr');
+      this.verifyTrue(newsr == filt.down, 'newsr != filt.down');
+      this.verifyTrue(numel(outdata) == ceil(numel(data) * filt.down / filt.sr), 'outdata has wrong length');
       this.verifyTrue(~isempty(outdata), 'outdata is empty');
     end
     function below_nyquist_downsample_test(this)
@@ -135,5 +136,52 @@ classdef pspm_prepdata_test < matlab.unittest.TestCase
       this.verifyTrue(newsr == 2*filt.lpfreq, 'newsr != 2*filt.lpfreq');
       this.verifyTrue(~isempty(outdata), 'outdata is empty');
     end
+    function multichannel_test(this)
+      % a matrix is filtered column by column
+      filt.sr = 100;
+      filt.lpfreq = 5;
+      filt.lporder = 1;
+      filt.hpfreq = 0.5;
+      filt.hporder = 1;
+      filt.down = 'none';
+      data = cumsum(randn(1000, 3));
+      data(100:120, 2) = NaN;
+      for direction = {'uni', 'bi'}
+        filt.direction = direction{1};
+        [sts, outdata, newsr] = pspm_prepdata(data, filt);
+        this.verifyEqual(sts, 1);
+        this.verifyEqual(newsr, filt.sr);
+        this.verifySize(outdata, size(data));
+        for k = 1:size(data, 2)
+          [~, col] = pspm_prepdata(data(:, k), filt);
+          this.verifyEqual(outdata(:, k), col, 'AbsTol', 1e-10);
+        end
+      end
+    end
+    function blockwise_test(this)
+      filt.sr = 100;
+      filt.lpfreq = 5;
+      filt.lporder = 4;
+      filt.hpfreq = 0.5;
+      filt.hporder = 1;
+      filt.down = 10;
+      data = cumsum(randn(5000, 1));
+      data([1:3, 2000:2300, 4990:5000]) = NaN;
+      options.blocksize = 700;
+      % unidirectional filtering gives the same result block by block
+      filt.direction = 'uni';
+      [~, whole] = pspm_prepdata(data, filt);
+      [sts, blocks, newsr] = pspm_prepdata(data, filt, options);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(newsr, filt.down);
+      this.verifyEqual(blocks, whole, 'AbsTol', 1e-8);
+      this.verifyEqual(isnan(blocks), isnan(whole));
+      % bidirectional filtering agrees once the filter response has decayed
+      filt.direction = 'bi';
+      [~, whole] = pspm_prepdata(data, filt);
+      [sts, blocks] = pspm_prepdata(data, filt, options);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(blocks, whole, 'AbsTol', 1e-6);
+    end
   end
-end
\ No newline at end of file
+end
@@ -0,0 +1,53 @@
+classdef pspm_route_lines_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_route_lines function
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_route_lines('abc'), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_route_lines(1, struct('pattern', '')), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_route_lines('abc', struct('tag', '')), 'ID:invalid_input');
+    end
+    function line_index(this)
+      % Windows and Unix line endings, and a last line without newline
+      str = sprintf('ab\r\nc\n\ndef');
+      [sts, out] = pspm_route_lines(str, struct('pattern', ''));
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(out.linebeg, [1, 5, 7, 8]);
+      this.verifyEqual(out.lineend, [2, 5, 6, 10]);
+      this.verifyEqual(out.route.lines, 1:4);
+      this.verifyEqual(out.route.data, {'ab', 'c', '', 'def'});
+    end
+    function routes(this)
+      % lines go to the first matching route, the rest to the empty pattern;
+      % lines before firstline are not routed
+      str = sprintf(['# header\n', ...
+        '10\t1.5\t2\tx\n', ...
+        'MSG\t1.7\tstart\n', ...
+        '10\t1.6\t.\ty\n', ...
+        '11\t1.8\t3\n', ...
+        '10\t1.9\t4\tz\n']);
+      routes = struct('pattern', {'10\t', 'MSG\t', ''}, ...
+        'format', {'%*f %f %f %s', '', ''}, ...
+        'options', {{'Delimiter', '\t', 'TreatAsEmpty', '.'}, {}, {}});
+      [sts, out] = pspm_route_lines(str, routes, 2);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(out.route(1).lines, [2, 4, 6]);
+      this.verifyEqual(out.route(1).data{1}, [1.5; 1.6; 1.9]);
+      this.verifyEqual(out.route(1).data{2}, [2; NaN; 4]);
+      this.verifyEqual(out.route(1).data{3}, {'x'; 'y'; 'z'});
+      this.verifyEqual(out.route(2).data, {sprintf('MSG\t1.7\tstart')});
+      this.verifyEqual(out.route(3).lines, 5);
+      this.verifyEqual(out.route(3).data, {sprintf('11\t1.8\t3')});
+    end
+    function auto_format(this)
+      % numeric fields and '.' are read, text fields are skipped
+      str = sprintf('1\tL\t.\t0.5\n2\tR\t3\t0.25\n');
+      routes = struct('pattern', '', 'format', 'auto', ...
+        'options', {{'Delimiter', '\t', 'TreatAsEmpty', '.'}});
+      [sts, out] = pspm_route_lines(str, routes);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(out.route.format, '%f%*s%f%f');
+      this.verifyEqual([out.route.data{:}], [1, NaN, 0.5; 2, 3, 0.25]);
+    end
+  end
+end
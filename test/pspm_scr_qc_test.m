@@ -0,0 +1,42 @@
+classdef pspm_scr_qc_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_scr_qc function
+  properties(Constant)
+    sr = 100;
+  end
+  methods (Test)
+    function invalid_input(this)
+      this.verifyWarning(@() pspm_scr_qc(1), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_scr_qc(1, this.sr), 'ID:invalid_input');
+      this.verifyWarning(@() pspm_scr_qc(ones(10, 1), -1), 'ID:invalid_input');
+    end
+    function range_and_slope(this)
+      data = 5 * ones(2000, 1);
+      data(500:520) = 100;
+      options = struct('expand_epochs', 0, 'deflection_threshold', 0);
+      [sts, out, missing_epochs] = pspm_scr_qc(data, this.sr, options);
+      this.verifyEqual(sts, 1);
+      % the sample after the artefact has a steep slope
+      this.verifyEqual(missing_epochs, [499, 521] / this.sr, 'AbsTol', 1e-12);
+      this.verifyTrue(all(isnan(out(500:521))));
+      this.verifyEqual(out([1:499, 522:end]), data([1:499, 522:end]));
+      % expansion by 0.1 s
+      options.expand_epochs = 0.1;
+      [~, out, missing_epochs] = pspm_scr_qc(data, this.sr, options);
+      this.verifyEqual(missing_epochs, [489, 531] / this.sr, 'AbsTol', 1e-12);
+      this.verifyEqual(sum(isnan(out)), 42);
+    end
+    function clipping(this)
+      t = (1:2000)';
+      data = min(5 + 0.5 * sin(2 * pi * t / 400), 5.3);
+      options = struct('expand_epochs', 0, 'deflection_threshold', 0, ...
+        'clipping_window_size', 50, 'clipping_step_size', 5);
+      [sts, out, missing_epochs] = pspm_scr_qc(data, this.sr, options);
+      this.verifyEqual(sts, 1);
+      this.verifyNotEmpty(missing_epochs);
+      % plateau is removed, trough is kept
+      this.verifyTrue(isnan(out(100)));
+      this.verifyEqual(out(300), data(300));
+    end
+  end
+end
@@ -0,0 +1,71 @@
+classdef pspm_sf_mp_test < matlab.unittest.TestCase
+  % ● Description
+  % unittest class for the pspm_sf_mp function
+  properties(Constant)
+    sr = 10;
+    n = 600;
+  end
+  methods (Test)
+    function invalid_input(this)
+      options = struct('dispwin', 0);
+      sts = pspm_sf_mp(struct('scr', zeros(10, 2), 'sr', this.sr), options);
+      this.verifyEqual(sts, -1);
+      sts = pspm_sf_mp(struct('scr', zeros(10, 1), 'sr', 0), options);
+      this.verifyEqual(sts, -1);
+    end
+    function recovers_responses(this)
+      % two SF with onsets 15 s and 35 s, such that the data start at zero
+      options = struct('dispwin', 0, 'diagnostics', 1);
+      [sts, out] = pspm_sf_mp(struct('scr', zeros(this.n, 1), 'sr', this.sr), options);
+      this.verifyEqual(sts, 1);
+      D = out.D;
+      this.verifySize(D.D, [D.phasicterms, this.n]);
+      atomind = [find(abs(D.tindx - 15) < 1e-9), find(abs(D.tindx - 35) < 1e-9)];
+      amp = [1, 0.5];
+      scr = (amp * D.D(atomind, :))';
+      [sts, out] = pspm_sf_mp(struct('scr', scr, 'sr', this.sr), options);
+      this.verifyEqual(sts, 1);
+      this.verifyEqual(out.yhat, out.y', 'AbsTol', 0.05);
+      % the largest responses are found at the simulated onsets
+      [~, k] = sort(out.a, 'descend');
+      this.verifyEqual(sort(out.ind(k(1:2)))', atomind);
+      this.verifyEqual(out.a(k(1)), 1, 'RelTol', 0.05);
+      this.verifyEqual(out.yhatraw, out.y', 'AbsTol', 0.05);
+    end
+    function tail_atoms(this)
+      % atoms 1..ntail model SF that started before the segment; in a 40 s
+      % segment their tails end before the segment does, such that the
+      % data keep their minimum at zero
+      n = 400;
+      options = struct('dispwin', 0, 'diagnostics', 1);
+      [sts, out] = pspm_sf_mp(struct('scr', zeros(n, 1), 'sr', this.sr), options);
+      this.verifyEqual(sts, 1);
+      D = out.D;
+      ntail = floor(out.S.ntail);
+      this.verifySize(D.D, [ntail + n, n]);
+      % norms of the implicit dictionary equal those of the dense one
+      this.verifyEqual(D.aD, sqrt(sum(D.D.^2, 2)), 'AbsTol', 1e-10);
+      for onset = [-1.5, -0.5]
+        % a single tail atom is recovered from its own inner product
+        i = find(abs(D.tindx - onset) < 1e-9);
+        this.verifyLessThanOrEqual(i, ntail);
+        scr = D.D(i, :)';
+        [sts, out] = pspm_sf_mp(struct('scr', scr, 'sr', this.sr), options);
+        this.verifyEqual(sts, 1);
+        this.verifyEqual(out.ind, i);
+        this.verifyEqual(out.rawa, (D.D(i, :) * scr) / D.aD(i)^2, 'RelTol', 1e-8);
+        this.verifyEqual(out.a, 1, 'RelTol', 1e-8);
+        this.verifyEqual(out.yhat, scr', 'AbsTol', 1e-8);
+      end
+    end
+    function no_diagnostics(this)
+      options = struct('dispwin', 0, 'diagnostics', 0);
+      scr = sin((1:this.n)' / 40) + 1;
+      [sts, out] = pspm_sf_mp(struct('scr', scr, 'sr', this.sr), options);
+      this.verifyEqual(sts, 1);
+      this.verifyFalse(isfield(out, 'D'));
+      this.verifyEqual(numel(out.t), numel(out.a));
+      this.verifyEqual(numel(out.a), numel(out.rawa));
+    end
+  end
+end